@@ -0,0 +1,775 @@
+#include "AnalysisKernels.h"
+#include <cmath>
+#include <algorithm>
+#include <complex>
+
+#if defined (__AVX__) || JUCE_USE_SSE_INTRINSICS
+ #include <immintrin.h>
+#elif JUCE_USE_ARM_NEON
+ #include <arm_neon.h>
+#endif
+
+namespace
+{
+#if defined (__AVX__)
+struct FloatLanes
+{
+    using Type = __m256;
+    static constexpr int size = 8;
+
+    static Type load (const float* source) noexcept          { return _mm256_loadu_ps (source); }
+    static void store (float* dest, Type value) noexcept     { _mm256_storeu_ps (dest, value); }
+    static Type expand (float value) noexcept                { return _mm256_set1_ps (value); }
+    static Type add (Type a, Type b) noexcept                { return _mm256_add_ps (a, b); }
+    static Type sub (Type a, Type b) noexcept                { return _mm256_sub_ps (a, b); }
+    static Type mul (Type a, Type b) noexcept                { return _mm256_mul_ps (a, b); }
+    static Type max (Type a, Type b) noexcept                { return _mm256_max_ps (a, b); }
+    static Type min (Type a, Type b) noexcept                { return _mm256_min_ps (a, b); }
+};
+#elif JUCE_USE_SSE_INTRINSICS
+struct FloatLanes
+{
+    using Type = __m128;
+    static constexpr int size = 4;
+
+    static Type load (const float* source) noexcept          { return _mm_loadu_ps (source); }
+    static void store (float* dest, Type value) noexcept     { _mm_storeu_ps (dest, value); }
+    static Type expand (float value) noexcept                { return _mm_set1_ps (value); }
+    static Type add (Type a, Type b) noexcept                { return _mm_add_ps (a, b); }
+    static Type sub (Type a, Type b) noexcept                { return _mm_sub_ps (a, b); }
+    static Type mul (Type a, Type b) noexcept                { return _mm_mul_ps (a, b); }
+    static Type max (Type a, Type b) noexcept                { return _mm_max_ps (a, b); }
+    static Type min (Type a, Type b) noexcept                { return _mm_min_ps (a, b); }
+};
+#elif JUCE_USE_ARM_NEON
+struct FloatLanes
+{
+    using Type = float32x4_t;
+    static constexpr int size = 4;
+
+    static Type load (const float* source) noexcept          { return vld1q_f32 (source); }
+    static void store (float* dest, Type value) noexcept     { vst1q_f32 (dest, value); }
+    static Type expand (float value) noexcept                { return vdupq_n_f32 (value); }
+    static Type add (Type a, Type b) noexcept                { return vaddq_f32 (a, b); }
+    static Type sub (Type a, Type b) noexcept                { return vsubq_f32 (a, b); }
+    static Type mul (Type a, Type b) noexcept                { return vmulq_f32 (a, b); }
+    static Type max (Type a, Type b) noexcept                { return vmaxq_f32 (a, b); }
+    static Type min (Type a, Type b) noexcept                { return vminq_f32 (a, b); }
+};
+#else
+struct FloatLanes
+{
+    using Type = float;
+    static constexpr int size = 1;
+
+    static Type load (const float* source) noexcept          { return *source; }
+    static void store (float* dest, Type value) noexcept     { *dest = value; }
+    static Type expand (float value) noexcept                { return value; }
+    static Type add (Type a, Type b) noexcept                { return a + b; }
+    static Type sub (Type a, Type b) noexcept                { return a - b; }
+    static Type mul (Type a, Type b) noexcept                { return a * b; }
+    static Type max (Type a, Type b) noexcept                { return a > b ? a : b; }
+    static Type min (Type a, Type b) noexcept                { return a < b ? a : b; }
+};
+#endif
+
+#if JUCE_USE_SSE_INTRINSICS || defined (__AVX__)
+struct FloatQuad
+{
+    using Type = __m128;
+
+    static Type load (const float* source) noexcept          { return _mm_load_ps (source); }
+    static void store (float* dest, Type value) noexcept     { _mm_store_ps (dest, value); }
+    static Type set (float a, float b, float c, float d) noexcept { return _mm_setr_ps (a, b, c, d); }
+    static Type add (Type a, Type b) noexcept                { return _mm_add_ps (a, b); }
+    static Type sub (Type a, Type b) noexcept                { return _mm_sub_ps (a, b); }
+    static Type mul (Type a, Type b) noexcept                { return _mm_mul_ps (a, b); }
+    static Type max (Type a, Type b) noexcept                { return _mm_max_ps (a, b); }
+    static Type abs (Type a) noexcept                        { return _mm_andnot_ps (_mm_set1_ps (-0.0f), a); }
+    static Type lowOfFirstHighOfSecond (Type a, Type b) noexcept { return _mm_shuffle_ps (a, b, _MM_SHUFFLE (3, 2, 1, 0)); }
+};
+#elif JUCE_USE_ARM_NEON
+struct FloatQuad
+{
+    using Type = float32x4_t;
+
+    static Type load (const float* source) noexcept          { return vld1q_f32 (source); }
+    static void store (float* dest, Type value) noexcept     { vst1q_f32 (dest, value); }
+    static Type set (float a, float b, float c, float d) noexcept { const float values[] { a, b, c, d }; return vld1q_f32 (values); }
+    static Type add (Type a, Type b) noexcept                { return vaddq_f32 (a, b); }
+    static Type sub (Type a, Type b) noexcept                { return vsubq_f32 (a, b); }
+    static Type mul (Type a, Type b) noexcept                { return vmulq_f32 (a, b); }
+    static Type max (Type a, Type b) noexcept                { return vmaxq_f32 (a, b); }
+    static Type abs (Type a) noexcept                        { return vabsq_f32 (a); }
+    static Type lowOfFirstHighOfSecond (Type a, Type b) noexcept { return vcombine_f32 (vget_low_f32 (a), vget_high_f32 (b)); }
+};
+#else
+struct FloatQuad
+{
+    struct Type { float v[4]; };
+
+    static Type load (const float* source) noexcept          { return { { source[0], source[1], source[2], source[3] } }; }
+    static void store (float* dest, Type value) noexcept     { std::copy (value.v, value.v + 4, dest); }
+    static Type set (float a, float b, float c, float d) noexcept { return { { a, b, c, d } }; }
+    static Type add (Type a, Type b) noexcept                { return { { a.v[0] + b.v[0], a.v[1] + b.v[1], a.v[2] + b.v[2], a.v[3] + b.v[3] } }; }
+    static Type sub (Type a, Type b) noexcept                { return { { a.v[0] - b.v[0], a.v[1] - b.v[1], a.v[2] - b.v[2], a.v[3] - b.v[3] } }; }
+    static Type mul (Type a, Type b) noexcept                { return { { a.v[0] * b.v[0], a.v[1] * b.v[1], a.v[2] * b.v[2], a.v[3] * b.v[3] } }; }
+    static Type max (Type a, Type b) noexcept                { return { { std::max (a.v[0], b.v[0]), std::max (a.v[1], b.v[1]), std::max (a.v[2], b.v[2]), std::max (a.v[3], b.v[3]) } }; }
+    static Type abs (Type a) noexcept                        { return { { std::abs (a.v[0]), std::abs (a.v[1]), std::abs (a.v[2]), std::abs (a.v[3]) } }; }
+    static Type lowOfFirstHighOfSecond (Type a, Type b) noexcept { return { { a.v[0], a.v[1], b.v[2], b.v[3] } }; }
+};
+#endif
+
+template <typename Operation>
+float reduceLanes (FloatLanes::Type value, float initial, Operation&& operation) noexcept
+{
+    float lanes[FloatLanes::size];
+    FloatLanes::store (lanes, value);
+
+    float result = initial;
+    for (float lane : lanes)
+        result = operation (result, lane);
+
+    return result;
+}
+
+// Float partial sums are flushed into the double totals this often to keep long blocks accurate.
+constexpr int accumulatorFlushSamples = 1024;
+}
+
+float BlockStatistics::getPeak (int channel) const noexcept
+{
+    return juce::jmax (maximum[channel], -minimum[channel], 0.0f);
+}
+
+float BlockStatistics::getRms (int channel) const noexcept
+{
+    return numSamples > 0 ? std::sqrt ((float) (sumSquares[channel] / (double) numSamples)) : 0.0f;
+}
+
+float BlockStatistics::getMidRms() const noexcept
+{
+    return numSamples > 0 ? std::sqrt ((float) (midSumSquares / (double) numSamples)) : 0.0f;
+}
+
+float BlockStatistics::getSideRms() const noexcept
+{
+    return numSamples > 0 ? std::sqrt ((float) (sideSumSquares / (double) numSamples)) : 0.0f;
+}
+
+float BlockStatistics::getCorrelation() const noexcept
+{
+    const float magL = std::sqrt ((float) sumSquares[0]);
+    const float magR = std::sqrt ((float) sumSquares[1]);
+    if (magL > 1.0e-9f && magR > 1.0e-9f)
+        return juce::jlimit (-1.0f, 1.0f, (float) (crossProduct / (magL * magR)));
+
+    return 0.0f;
+}
+
+bool BlockStatistics::isClipped (int channel, float threshold) const noexcept
+{
+    return numSamples > 0 && (maximum[channel] >= threshold || minimum[channel] <= -threshold);
+}
+
+void WaveformBandFilterBank::prepare (double sampleRate, float lowCrossoverHz, float highCrossoverHz)
+{
+    using Coefficients = juce::dsp::IIR::Coefficients<float>;
+    const Coefficients::Ptr sections[2][2] =
+    {
+        { Coefficients::makeLowPass (sampleRate, lowCrossoverHz, 0.707f), Coefficients::makeHighPass (sampleRate, lowCrossoverHz, 0.707f) },
+        { Coefficients::makeHighPass (sampleRate, highCrossoverHz, 0.707f), Coefficients::makeLowPass (sampleRate, highCrossoverHz, 0.707f) }
+    };
+
+    for (int reg = 0; reg < 2; ++reg)
+    {
+        for (int lane = 0; lane < 4; ++lane)
+        {
+            const float* raw = sections[reg][lane / 2]->getRawCoefficients();
+            for (int c = 0; c < numCoefficients; ++c)
+                coefficients[reg][c][lane] = raw[c];
+        }
+    }
+
+    reset();
+}
+
+void WaveformBandFilterBank::reset() noexcept
+{
+    std::fill (&state[0][0][0], &state[0][0][0] + 2 * 2 * 4, 0.0f);
+}
+
+void WaveformBandFilterBank::process (const float* left, const float* right, int numSamples, BandEnergies& energies) noexcept
+{
+    using Q = FloatQuad;
+
+    Q::Type c[2][numCoefficients];
+    for (int reg = 0; reg < 2; ++reg)
+        for (int i = 0; i < numCoefficients; ++i)
+            c[reg][i] = Q::load (coefficients[reg][i]);
+
+    auto s1A = Q::load (state[0][0]), s2A = Q::load (state[0][1]);
+    auto s1B = Q::load (state[1][0]), s2B = Q::load (state[1][1]);
+    auto energyA = Q::set (0.0f, 0.0f, 0.0f, 0.0f);
+    auto energyB = energyA;
+
+    for (int i = 0; i < numSamples; ++i)
+    {
+        const auto xA = Q::set (left[i], right[i], left[i], right[i]);
+        const auto yA = Q::add (Q::mul (c[0][b0], xA), s1A);
+        s1A = Q::add (Q::sub (Q::mul (c[0][b1], xA), Q::mul (c[0][a1], yA)), s2A);
+        s2A = Q::sub (Q::mul (c[0][b2], xA), Q::mul (c[0][a2], yA));
+
+        const auto xB = Q::lowOfFirstHighOfSecond (xA, yA);
+        const auto yB = Q::add (Q::mul (c[1][b0], xB), s1B);
+        s1B = Q::add (Q::sub (Q::mul (c[1][b1], xB), Q::mul (c[1][a1], yB)), s2B);
+        s2B = Q::sub (Q::mul (c[1][b2], xB), Q::mul (c[1][a2], yB));
+
+        energyA = Q::add (energyA, Q::mul (yA, yA));
+        energyB = Q::add (energyB, Q::mul (yB, yB));
+    }
+
+    Q::store (state[0][0], s1A);
+    Q::store (state[0][1], s2A);
+    Q::store (state[1][0], s1B);
+    Q::store (state[1][1], s2B);
+
+    alignas (16) float sumsA[4], sumsB[4];
+    Q::store (sumsA, energyA);
+    Q::store (sumsB, energyB);
+
+    for (int ch = 0; ch < 2; ++ch)
+    {
+        energies[(size_t) ch][0] += sumsA[ch];
+        energies[(size_t) ch][1] += sumsB[2 + ch];
+        energies[(size_t) ch][2] += sumsB[ch];
+    }
+}
+
+void KWeightingFilterBank::prepare (double sampleRate, int numChannels)
+{
+    using Coefficients = juce::dsp::IIR::Coefficients<float>;
+    const Coefficients::Ptr stages[numStages] =
+    {
+        Coefficients::makeHighShelf (sampleRate, 1680.0f, 0.707f, juce::Decibels::decibelsToGain (4.0f)),
+        Coefficients::makeHighPass (sampleRate, 38.0f, 0.5f)
+    };
+
+    for (int stage = 0; stage < numStages; ++stage)
+    {
+        const float* raw = stages[stage]->getRawCoefficients();
+        for (int c = 0; c < numCoefficients; ++c)
+            std::fill (coefficients[stage][c].values, coefficients[stage][c].values + 4, raw[c]);
+    }
+
+    numGroups = (juce::jmax (0, numChannels) + 3) / 4;
+    state.assign ((size_t) (numGroups * numStages * 2), Lanes {});
+}
+
+void KWeightingFilterBank::reset() noexcept
+{
+    std::fill (state.begin(), state.end(), Lanes {});
+}
+
+void KWeightingFilterBank::process (const float* const* input, float* const* output, int numChannels, int numSamples) noexcept
+{
+    using Q = FloatQuad;
+
+    Q::Type c[numStages][numCoefficients];
+    for (int stage = 0; stage < numStages; ++stage)
+        for (int i = 0; i < numCoefficients; ++i)
+            c[stage][i] = Q::load (coefficients[stage][i].values);
+
+    numChannels = juce::jmin (numChannels, numGroups * 4);
+
+    for (int group = 0; group * 4 < numChannels; ++group)
+    {
+        const int firstChannel = group * 4;
+        const int lanesUsed = juce::jmin (4, numChannels - firstChannel);
+        const float* source[4];
+        for (int lane = 0; lane < 4; ++lane)
+            source[lane] = input[firstChannel + juce::jmin (lane, lanesUsed - 1)];
+
+        auto* groupState = state.data() + group * numStages * 2;
+        auto s1A = Q::load (groupState[0].values), s2A = Q::load (groupState[1].values);
+        auto s1B = Q::load (groupState[2].values), s2B = Q::load (groupState[3].values);
+        alignas (16) float lanes[4];
+
+        for (int i = 0; i < numSamples; ++i)
+        {
+            const auto x = Q::set (source[0][i], source[1][i], source[2][i], source[3][i]);
+            const auto shelved = Q::add (Q::mul (c[0][b0], x), s1A);
+            s1A = Q::add (Q::sub (Q::mul (c[0][b1], x), Q::mul (c[0][a1], shelved)), s2A);
+            s2A = Q::sub (Q::mul (c[0][b2], x), Q::mul (c[0][a2], shelved));
+
+            const auto y = Q::add (Q::mul (c[1][b0], shelved), s1B);
+            s1B = Q::add (Q::sub (Q::mul (c[1][b1], shelved), Q::mul (c[1][a1], y)), s2B);
+            s2B = Q::sub (Q::mul (c[1][b2], shelved), Q::mul (c[1][a2], y));
+
+            Q::store (lanes, y);
+            for (int lane = 0; lane < lanesUsed; ++lane)
+                output[firstChannel + lane][i] = lanes[lane];
+        }
+
+        Q::store (groupState[0].values, s1A);
+        Q::store (groupState[1].values, s2A);
+        Q::store (groupState[2].values, s1B);
+        Q::store (groupState[3].values, s2B);
+    }
+}
+
+void TruePeakDetector::prepare (double sampleRate, int numChannels, int oversamplingFactor)
+{
+    // Higher base rates already resolve most of the inter-sample peak, so the factor is reduced to match.
+    const int baseRateMultiple = juce::jmax (1, juce::roundToInt (sampleRate / 48000.0));
+    phases = juce::jmax (1, oversamplingFactor / baseRateMultiple);
+    numGroups = (juce::jmax (0, numChannels) + 3) / 4;
+
+    const int numTaps = phases * tapsPerPhase;
+    std::vector<float> kernel ((size_t) numTaps, 0.0f);
+
+    if (phases == 1)
+    {
+        kernel[0] = 1.0f;
+    }
+    else
+    {
+        std::vector<float> window ((size_t) numTaps);
+        juce::dsp::WindowingFunction<float>::fillWindowingTables (window.data(), (size_t) numTaps,
+                                                                  juce::dsp::WindowingFunction<float>::kaiser, false, 6.0f);
+
+        const double cutoff = 0.9;
+        const double centre = 0.5 * (double) (numTaps - 1);
+        for (int k = 0; k < numTaps; ++k)
+        {
+            const double t = cutoff * ((double) k - centre) / (double) phases;
+            const double sinc = std::abs (t) < 1.0e-9 ? 1.0 : std::sin (juce::MathConstants<double>::pi * t) / (juce::MathConstants<double>::pi * t);
+            kernel[(size_t) k] = (float) sinc * window[(size_t) k];
+        }
+    }
+
+    coefficients.assign ((size_t) numTaps, Lanes {});
+    for (int phase = 0; phase < phases; ++phase)
+    {
+        float gain = 0.0f;
+        for (int tap = 0; tap < tapsPerPhase; ++tap)
+            gain += kernel[(size_t) (phase + phases * tap)];
+
+        for (int tap = 0; tap < tapsPerPhase; ++tap)
+        {
+            auto& lanes = coefficients[(size_t) (phase * tapsPerPhase + tap)];
+            std::fill (lanes.values, lanes.values + 4, kernel[(size_t) (phase + phases * tap)] / gain);
+        }
+    }
+
+    history.assign ((size_t) (numGroups * 2 * tapsPerPhase), Lanes {});
+    reset();
+}
+
+void TruePeakDetector::reset() noexcept
+{
+    std::fill (history.begin(), history.end(), Lanes {});
+    historyPosition = 0;
+}
+
+void TruePeakDetector::process (const float* const* channels, int numChannels, int numSamples, float* peaks) noexcept
+{
+    using Q = FloatQuad;
+
+    numChannels = juce::jmin (numChannels, numGroups * 4);
+    int position = historyPosition;
+
+    for (int group = 0; group * 4 < numChannels; ++group)
+    {
+        const int firstChannel = group * 4;
+        const float* source[4];
+        for (int lane = 0; lane < 4; ++lane)
+            source[lane] = channels[juce::jmin (firstChannel + lane, numChannels - 1)];
+
+        auto* lanes = history.data() + group * 2 * tapsPerPhase;
+        auto peak = Q::set (0.0f, 0.0f, 0.0f, 0.0f);
+        position = historyPosition;
+
+        for (int i = 0; i < numSamples; ++i)
+        {
+            position = (position == 0 ? tapsPerPhase : position) - 1;
+            const auto input = Q::set (source[0][i], source[1][i], source[2][i], source[3][i]);
+            Q::store (lanes[position].values, input);
+            Q::store (lanes[position + tapsPerPhase].values, input);
+
+            const auto* taps = lanes + position;
+            const auto* phaseCoefficients = coefficients.data();
+            for (int phase = 0; phase < phases; ++phase, phaseCoefficients += tapsPerPhase)
+            {
+                auto sum = Q::mul (Q::load (phaseCoefficients[0].values), Q::load (taps[0].values));
+                for (int tap = 1; tap < tapsPerPhase; ++tap)
+                    sum = Q::add (sum, Q::mul (Q::load (phaseCoefficients[tap].values), Q::load (taps[tap].values)));
+
+                peak = Q::max (peak, Q::abs (sum));
+            }
+        }
+
+        alignas (16) float groupPeaks[4];
+        Q::store (groupPeaks, peak);
+        for (int lane = 0; lane < 4 && firstChannel + lane < numChannels; ++lane)
+            peaks[firstChannel + lane] = groupPeaks[lane];
+    }
+
+    if (numChannels > 0)
+        historyPosition = position;
+}
+
+void OctaveBandFilterBank::prepare (double sampleRate, int bandsPerOctave, float newAveragingSeconds)
+{
+    bandsPerOctave = bandsPerOctave >= 6 ? 6 : 3;
+    averagingSeconds = juce::jmax (0.01f, newAveragingSeconds);
+
+    // Base-ten midband frequencies, 1 kHz * 10^(x / (10 * b / 3)), from 20 Hz to 20 kHz.
+    const double octaveRatio = std::pow (10.0, 0.3);
+    const double halfBandRatio = std::pow (octaveRatio, 0.5 / (double) bandsPerOctave);
+    const int firstIndex = -17 * bandsPerOctave / 3;
+    const int lastIndex = 13 * bandsPerOctave / 3;
+
+    struct BandDesign
+    {
+        double lower = 0.0, upper = 0.0;
+        int stage = 0;
+    };
+
+    std::vector<BandDesign> designs;
+    centreFrequencies.clear();
+    int numStages = 1;
+
+    for (int x = firstIndex; x <= lastIndex && (int) designs.size() < maxBands; ++x)
+    {
+        const double centre = 1000.0 * std::pow (octaveRatio, (double) x / (double) bandsPerOctave);
+        BandDesign design { centre / halfBandRatio, centre * halfBandRatio, 0 };
+        if (design.upper >= 0.48 * sampleRate)
+            break;
+
+        while (design.stage + 1 < maxStages && design.upper <= 0.25 * sampleRate / (double) (1 << (design.stage + 1)))
+            ++design.stage;
+
+        numStages = juce::jmax (numStages, design.stage + 1);
+        designs.push_back (design);
+        centreFrequencies.push_back ((float) centre);
+    }
+
+    groups.clear();
+    for (int stage = 0; stage < numStages; ++stage)
+    {
+        for (int band = 0; band < (int) designs.size();)
+        {
+            if (designs[(size_t) band].stage != stage)
+            {
+                ++band;
+                continue;
+            }
+
+            Group group { stage, band, 0 };
+            while (group.numBands < 4 && band < (int) designs.size() && designs[(size_t) band].stage == stage)
+            {
+                ++group.numBands;
+                ++band;
+            }
+
+            groups.push_back (group);
+        }
+    }
+
+    coefficients.assign (groups.size() * numSections * numCoefficients, Lanes {});
+    state.assign (groups.size() * numSections * 2, Lanes {});
+    energies.assign (groups.size(), Lanes {});
+    meanSquares.assign (designs.size(), 0.0f);
+
+    for (size_t g = 0; g < groups.size(); ++g)
+    {
+        const auto& group = groups[g];
+        const double rate = sampleRate / (double) (1 << group.stage);
+        const double k = 2.0 * rate;
+
+        for (int lane = 0; lane < group.numBands; ++lane)
+        {
+            const auto& design = designs[(size_t) (group.firstBand + lane)];
+            const double warpedLower = k * std::tan (juce::MathConstants<double>::pi * design.lower / rate);
+            const double warpedUpper = k * std::tan (juce::MathConstants<double>::pi * design.upper / rate);
+            const double bandwidth = warpedUpper - warpedLower;
+            const double centreSquared = warpedLower * warpedUpper;
+
+            // Low-pass to band-pass transform of the third-order Butterworth poles: the real pole gives
+            // one conjugate pair, the complex pair gives two.
+            std::array<std::complex<double>, numSections> poles;
+            poles[0] = 0.5 * (-bandwidth + std::sqrt (std::complex<double> (bandwidth * bandwidth - 4.0 * centreSquared)));
+            const auto prototype = std::polar (1.0, 2.0 * juce::MathConstants<double>::pi / 3.0);
+            const auto root = std::sqrt (prototype * prototype * bandwidth * bandwidth - 4.0 * centreSquared);
+            poles[1] = 0.5 * (prototype * bandwidth + root);
+            poles[2] = 0.5 * (prototype * bandwidth - root);
+
+            const auto z = std::polar (1.0, 2.0 * std::atan (std::sqrt (centreSquared) / k));
+            std::complex<double> response (1.0);
+            std::array<std::array<double, numCoefficients>, numSections> sections;
+
+            for (int section = 0; section < numSections; ++section)
+            {
+                const double analogA1 = -2.0 * poles[(size_t) section].real();
+                const double analogA0 = std::norm (poles[(size_t) section]);
+                const double d0 = k * k + analogA1 * k + analogA0;
+                auto& c = sections[(size_t) section];
+                c[b0] = bandwidth * k / d0;
+                c[b1] = 0.0;
+                c[b2] = -c[b0];
+                c[a1] = (2.0 * analogA0 - 2.0 * k * k) / d0;
+                c[a2] = (k * k - analogA1 * k + analogA0) / d0;
+
+                const auto zInverse = 1.0 / z;
+                response *= (c[b0] + c[b2] * zInverse * zInverse) / (1.0 + c[a1] * zInverse + c[a2] * zInverse * zInverse);
+            }
+
+            const double gain = 1.0 / juce::jmax (1.0e-12, std::abs (response));
+            sections[0][b0] *= gain;
+            sections[0][b2] *= gain;
+
+            for (int section = 0; section < numSections; ++section)
+                for (int c = 0; c < numCoefficients; ++c)
+                    coefficients[(g * numSections + (size_t) section) * numCoefficients + (size_t) c].values[lane] = (float) sections[(size_t) section][(size_t) c];
+        }
+    }
+
+    decimators.resize ((size_t) (numStages - 1));
+    decimated.resize ((size_t) numStages);
+    pendingSamples.assign ((size_t) numStages, 0);
+    stageRates.resize ((size_t) numStages);
+    for (int stage = 0; stage < numStages; ++stage)
+    {
+        stageRates[(size_t) stage] = (float) (sampleRate / (double) (1 << stage));
+        if (stage > 0)
+        {
+            decimators[(size_t) stage - 1].prepare();
+            decimated[(size_t) stage].assign ((size_t) (maxChunkSize >> stage) + 1, 0.0f);
+        }
+    }
+}
+
+void OctaveBandFilterBank::reset() noexcept
+{
+    std::fill (state.begin(), state.end(), Lanes {});
+    std::fill (energies.begin(), energies.end(), Lanes {});
+    std::fill (meanSquares.begin(), meanSquares.end(), 0.0f);
+    std::fill (pendingSamples.begin(), pendingSamples.end(), 0);
+    for (auto& decimator : decimators)
+        decimator.reset();
+}
+
+void OctaveBandFilterBank::process (const float* samples, int numSamples) noexcept
+{
+    using Q = FloatQuad;
+
+    if (groups.empty())
+        return;
+
+    std::array<const float*, maxStages> stageInput {};
+    std::array<int, maxStages> stageCount {};
+    const int numStages = (int) stageRates.size();
+
+    while (numSamples > 0)
+    {
+        const int chunk = juce::jmin (numSamples, maxChunkSize);
+        stageInput[0] = samples;
+        stageCount[0] = chunk;
+        for (int stage = 1; stage < numStages; ++stage)
+        {
+            stageInput[(size_t) stage] = decimated[(size_t) stage].data();
+            stageCount[(size_t) stage] = decimators[(size_t) stage - 1].process (stageInput[(size_t) stage - 1], stageCount[(size_t) stage - 1],
+                                                                                   decimated[(size_t) stage].data());
+        }
+
+        for (size_t g = 0; g < groups.size(); ++g)
+        {
+            const int stage = groups[g].stage;
+            const float* input = stageInput[(size_t) stage];
+            const int count = stageCount[(size_t) stage];
+
+            Q::Type c[numSections][numCoefficients];
+            for (int section = 0; section < numSections; ++section)
+                for (int i = 0; i < numCoefficients; ++i)
+                    c[section][i] = Q::load (coefficients[(g * numSections + (size_t) section) * numCoefficients + (size_t) i].values);
+
+            auto* groupState = state.data() + g * numSections * 2;
+            Q::Type s1[numSections], s2[numSections];
+            for (int section = 0; section < numSections; ++section)
+            {
+                s1[section] = Q::load (groupState[section * 2].values);
+                s2[section] = Q::load (groupState[section * 2 + 1].values);
+            }
+
+            auto energy = Q::load (energies[g].values);
+
+            for (int i = 0; i < count; ++i)
+            {
+                auto x = Q::set (input[i], input[i], input[i], input[i]);
+                for (int section = 0; section < numSections; ++section)
+                {
+                    const auto y = Q::add (Q::mul (c[section][b0], x), s1[section]);
+                    s1[section] = Q::add (Q::sub (Q::mul (c[section][b1], x), Q::mul (c[section][a1], y)), s2[section]);
+                    s2[section] = Q::sub (Q::mul (c[section][b2], x), Q::mul (c[section][a2], y));
+                    x = y;
+                }
+
+                energy = Q::add (energy, Q::mul (x, x));
+            }
+
+            for (int section = 0; section < numSections; ++section)
+            {
+                Q::store (groupState[section * 2].values, s1[section]);
+                Q::store (groupState[section * 2 + 1].values, s2[section]);
+            }
+
+            Q::store (energies[g].values, energy);
+        }
+
+        for (int stage = 0; stage < numStages; ++stage)
+            pendingSamples[(size_t) stage] += stageCount[(size_t) stage];
+
+        samples += chunk;
+        numSamples -= chunk;
+    }
+
+    // Block-wise exponential averaging of each band's mean square, time constant averagingSeconds.
+    for (size_t g = 0; g < groups.size(); ++g)
+    {
+        const auto& group = groups[g];
+        const int count = pendingSamples[(size_t) group.stage];
+        if (count <= 0)
+            continue;
+
+        const float blockSeconds = (float) count / stageRates[(size_t) group.stage];
+        const float retain = std::exp (-blockSeconds / averagingSeconds);
+        for (int lane = 0; lane < group.numBands; ++lane)
+        {
+            auto& meanSquare = meanSquares[(size_t) (group.firstBand + lane)];
+            const float blockMeanSquare = energies[g].values[lane] / (float) count;
+            meanSquare = retain * meanSquare + (1.0f - retain) * blockMeanSquare;
+            energies[g].values[lane] = 0.0f;
+        }
+    }
+
+    std::fill (pendingSamples.begin(), pendingSamples.end(), 0);
+}
+
+namespace AnalysisKernels
+{
+BlockStatistics computeBlockStatistics (const float* left, const float* right, float* monoOut, int numSamples) noexcept
+{
+    BlockStatistics stats;
+    stats.numSamples = juce::jmax (0, numSamples);
+    if (numSamples <= 0)
+        return stats;
+
+    using L = FloatLanes;
+    const int vectorEnd = numSamples - numSamples % L::size;
+
+    if (vectorEnd == 0)
+        return computeBlockStatisticsReference (left, right, monoOut, numSamples);
+
+    const auto half = L::expand (0.5f);
+    auto maxL = L::load (left), minL = maxL;
+    auto maxR = L::load (right), minR = maxR;
+
+    for (int chunkStart = 0; chunkStart < vectorEnd; chunkStart += accumulatorFlushSamples)
+    {
+        const int chunkEnd = juce::jmin (vectorEnd, chunkStart + accumulatorFlushSamples);
+        auto sumLL = L::expand (0.0f), sumRR = sumLL, sumLR = sumLL, sumMid = sumLL, sumSide = sumLL;
+
+        for (int i = chunkStart; i < chunkEnd; i += L::size)
+        {
+            const auto l = L::load (left + i);
+            const auto r = L::load (right + i);
+            const auto sum = L::add (l, r);
+            const auto diff = L::sub (l, r);
+
+            if (monoOut != nullptr)
+                L::store (monoOut + i, L::mul (sum, half));
+
+            sumLL = L::add (sumLL, L::mul (l, l));
+            sumRR = L::add (sumRR, L::mul (r, r));
+            sumLR = L::add (sumLR, L::mul (l, r));
+            sumMid = L::add (sumMid, L::mul (sum, sum));
+            sumSide = L::add (sumSide, L::mul (diff, diff));
+
+            maxL = L::max (maxL, l);
+            minL = L::min (minL, l);
+            maxR = L::max (maxR, r);
+            minR = L::min (minR, r);
+        }
+
+        const auto plus = [] (float a, float b) { return a + b; };
+        stats.sumSquares[0] += reduceLanes (sumLL, 0.0f, plus);
+        stats.sumSquares[1] += reduceLanes (sumRR, 0.0f, plus);
+        stats.crossProduct += reduceLanes (sumLR, 0.0f, plus);
+        stats.midSumSquares += 0.5 * reduceLanes (sumMid, 0.0f, plus);
+        stats.sideSumSquares += 0.5 * reduceLanes (sumSide, 0.0f, plus);
+    }
+
+    const auto maxOf = [] (float a, float b) { return a > b ? a : b; };
+    const auto minOf = [] (float a, float b) { return a < b ? a : b; };
+    stats.maximum[0] = reduceLanes (maxL, left[0], maxOf);
+    stats.minimum[0] = reduceLanes (minL, left[0], minOf);
+    stats.maximum[1] = reduceLanes (maxR, right[0], maxOf);
+    stats.minimum[1] = reduceLanes (minR, right[0], minOf);
+
+    for (int i = vectorEnd; i < numSamples; ++i)
+    {
+        const float l = left[i];
+        const float r = right[i];
+        const float sum = l + r;
+        const float diff = l - r;
+        if (monoOut != nullptr)
+            monoOut[i] = 0.5f * sum;
+        stats.sumSquares[0] += (double) (l * l);
+        stats.sumSquares[1] += (double) (r * r);
+        stats.crossProduct += (double) (l * r);
+        stats.midSumSquares += 0.5 * (double) (sum * sum);
+        stats.sideSumSquares += 0.5 * (double) (diff * diff);
+        stats.maximum[0] = juce::jmax (stats.maximum[0], l);
+        stats.minimum[0] = juce::jmin (stats.minimum[0], l);
+        stats.maximum[1] = juce::jmax (stats.maximum[1], r);
+        stats.minimum[1] = juce::jmin (stats.minimum[1], r);
+    }
+
+    return stats;
+}
+
+BlockStatistics computeBlockStatisticsReference (const float* left, const float* right, float* monoOut, int numSamples) noexcept
+{
+    BlockStatistics stats;
+    stats.numSamples = juce::jmax (0, numSamples);
+    if (numSamples <= 0)
+        return stats;
+
+    constexpr double sqrtHalf = 1.0 / juce::MathConstants<double>::sqrt2;
+    stats.maximum[0] = stats.minimum[0] = left[0];
+    stats.maximum[1] = stats.minimum[1] = right[0];
+
+    for (int i = 0; i < numSamples; ++i)
+    {
+        const double l = left[i];
+        const double r = right[i];
+        const double mid = (l + r) * sqrtHalf;
+        const double side = (l - r) * sqrtHalf;
+
+        if (monoOut != nullptr)
+            monoOut[i] = 0.5f * (left[i] + right[i]);
+        stats.sumSquares[0] += l * l;
+        stats.sumSquares[1] += r * r;
+        stats.crossProduct += l * r;
+        stats.midSumSquares += mid * mid;
+        stats.sideSumSquares += side * side;
+        stats.maximum[0] = juce::jmax (stats.maximum[0], left[i]);
+        stats.minimum[0] = juce::jmin (stats.minimum[0], left[i]);
+        stats.maximum[1] = juce::jmax (stats.maximum[1], right[i]);
+        stats.minimum[1] = juce::jmin (stats.minimum[1], right[i]);
+    }
+
+    return stats;
+}
+}
@@ -0,0 +1,152 @@
+#pragma once
+#include <JuceHeader.h>
+#include <array>
+#include <vector>
+#include "SpectralAnalysis.h"
+
+struct BlockStatistics
+{
+    int numSamples = 0;
+    float maximum[2] { 0.0f, 0.0f };
+    float minimum[2] { 0.0f, 0.0f };
+    double sumSquares[2] { 0.0, 0.0 };
+    double crossProduct = 0.0;
+    double midSumSquares = 0.0;
+    double sideSumSquares = 0.0;
+
+    float getPeak (int channel) const noexcept;
+    float getRms (int channel) const noexcept;
+    float getMidRms() const noexcept;
+    float getSideRms() const noexcept;
+    float getCorrelation() const noexcept;
+    bool isClipped (int channel, float threshold = 0.999f) const noexcept;
+};
+
+/** Low / mid / high split of a stereo signal for the waveform band display.
+    All eight biquads run as two 4-lane transposed direct form II registers:
+    [lowL, lowR, midHighPassL, midHighPassR] and [highL, highR, midLowPassL, midLowPassR],
+    where the mid low-pass lanes are fed by the mid high-pass outputs of the same sample. */
+class WaveformBandFilterBank
+{
+public:
+    using BandEnergies = std::array<std::array<float, 3>, 2>;
+
+    void prepare (double sampleRate, float lowCrossoverHz, float highCrossoverHz);
+    void reset() noexcept;
+
+    /** Filters the block and adds each band's squared output to energies[channel][band]. */
+    void process (const float* left, const float* right, int numSamples, BandEnergies& energies) noexcept;
+
+private:
+    enum { b0, b1, b2, a1, a2, numCoefficients };
+
+    alignas (16) float coefficients[2][numCoefficients][4] {};
+    alignas (16) float state[2][2][4] {};
+};
+
+/** BS.1770 K-weighting (high shelf into high-pass) for any number of channels.
+    Channels are filtered four at a time, one per SIMD lane, from and into separate channel arrays. */
+class KWeightingFilterBank
+{
+public:
+    void prepare (double sampleRate, int numChannels);
+    void reset() noexcept;
+
+    void process (const float* const* input, float* const* output, int numChannels, int numSamples) noexcept;
+
+private:
+    enum { b0, b1, b2, a1, a2, numCoefficients };
+    static constexpr int numStages = 2;
+    struct alignas (16) Lanes { float values[4]; };
+
+    Lanes coefficients[numStages][numCoefficients] {};
+    std::vector<Lanes> state;
+    int numGroups = 0;
+};
+
+/** Inter-sample peak detector in the style of ITU-R BS.1770 Annex 2.
+    Every channel is upsampled with a polyphase windowed-sinc FIR and the largest absolute
+    interpolated value of each block is reported. Channels run four at a time, one per SIMD lane. */
+class TruePeakDetector
+{
+public:
+    void prepare (double sampleRate, int numChannels, int oversamplingFactor);
+    void reset() noexcept;
+
+    /** Writes the linear true peak of the block for each channel into peaks. */
+    void process (const float* const* channels, int numChannels, int numSamples, float* peaks) noexcept;
+
+    int getOversamplingFactor() const noexcept { return phases; }
+
+private:
+    struct alignas (16) Lanes { float values[4]; };
+    static constexpr int tapsPerPhase = 12;
+
+    int phases = 1;
+    int numGroups = 0;
+    int historyPosition = 0;
+    std::vector<Lanes> coefficients;
+    std::vector<Lanes> history;
+};
+
+/** Constant-percentage bandwidth analyser in the style of IEC 61260: one sixth-order Butterworth
+    band-pass (three biquads) per base-ten fractional-octave band, with exponential RMS ballistics.
+    Each band runs at the lowest rate of a half-band decimation chain that still leaves its upper
+    edge below a quarter of the rate, so the low octaves cost almost nothing, and the bands of a
+    stage are filtered four at a time, one per SIMD lane. */
+class OctaveBandFilterBank
+{
+public:
+    static constexpr int maxBands = 64;
+
+    /** bandsPerOctave is 3 (31 bands from 20 Hz to 20 kHz) or 6 (61 bands). */
+    void prepare (double sampleRate, int bandsPerOctave, float averagingSeconds);
+    void reset() noexcept;
+
+    /** Filters a mono block and updates every band's averaged level. */
+    void process (const float* samples, int numSamples) noexcept;
+
+    int getNumBands() const noexcept { return (int) centreFrequencies.size(); }
+    float getCentreFrequency (int band) const noexcept { return centreFrequencies[(size_t) band]; }
+
+    /** Averaged RMS level of a band, linear. */
+    float getBandLevel (int band) const noexcept { return std::sqrt (meanSquares[(size_t) band]); }
+
+private:
+    enum { b0, b1, b2, a1, a2, numCoefficients };
+    static constexpr int numSections = 3;
+    static constexpr int maxStages = 10;
+    static constexpr int maxChunkSize = 1024;
+    struct alignas (16) Lanes { float values[4]; };
+
+    struct Group
+    {
+        int stage = 0;
+        int firstBand = 0;
+        int numBands = 0;
+    };
+
+    std::vector<float> centreFrequencies;
+    std::vector<float> meanSquares;
+    std::vector<Group> groups;
+    std::vector<Lanes> coefficients;
+    std::vector<Lanes> state;
+    std::vector<Lanes> energies;
+
+    std::vector<HalfBandDecimator> decimators;
+    std::vector<std::vector<float>> decimated;
+    std::vector<int> pendingSamples;
+    std::vector<float> stageRates;
+    float averagingSeconds = 0.125f;
+};
+
+namespace AnalysisKernels
+{
+    /** Computes peak, min/max, RMS, mid/side, correlation sums and the mono downmix
+        ((left + right) / 2) in one vectorised pass. Pass the same pointer twice for mono input;
+        monoOut may be nullptr when the downmix is not needed. */
+    BlockStatistics computeBlockStatistics (const float* left, const float* right, float* monoOut, int numSamples) noexcept;
+
+    /** Straightforward scalar version of computeBlockStatistics, kept for verification. */
+    BlockStatistics computeBlockStatisticsReference (const float* left, const float* right, float* monoOut, int numSamples) noexcept;
+}
@@ -0,0 +1,216 @@
+#pragma once
+#include <JuceHeader.h>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+/** Wait-free single-producer/single-consumer triple buffer.
+    The producer fills getWriteFrame() and calls publish(); the consumer calls fetch() and reads
+    getReadFrame(), which always holds the most recently published complete frame.
+    getSequence() counts publications; read before fetch(), an unchanged value means an unchanged frame. */
+template <typename FrameType>
+class TripleBuffer
+{
+public:
+    template <typename Initialiser>
+    void initialise (Initialiser&& initialiser)
+    {
+        for (auto& frame : frames)
+            initialiser (frame);
+
+        writeIndex = 0;
+        readIndex = 1;
+        state.store (2, std::memory_order_release);
+        sequence.fetch_add (1, std::memory_order_release);
+    }
+
+    FrameType& getWriteFrame() noexcept { return frames[(size_t) writeIndex]; }
+
+    void publish() noexcept
+    {
+        const int previous = state.exchange (writeIndex | dirtyFlag, std::memory_order_acq_rel);
+        writeIndex = previous & indexMask;
+        sequence.fetch_add (1, std::memory_order_release);
+    }
+
+    bool fetch() noexcept
+    {
+        if ((state.load (std::memory_order_relaxed) & dirtyFlag) == 0)
+            return false;
+
+        const int previous = state.exchange (readIndex, std::memory_order_acq_rel);
+        readIndex = previous & indexMask;
+        return true;
+    }
+
+    const FrameType& getReadFrame() const noexcept { return frames[(size_t) readIndex]; }
+
+    std::uint64_t getSequence() const noexcept { return sequence.load (std::memory_order_acquire); }
+
+private:
+    static constexpr int indexMask = 3;
+    static constexpr int dirtyFlag = 4;
+
+    std::array<FrameType, 3> frames {};
+    std::atomic<int> state { 2 };
+    std::atomic<std::uint64_t> sequence { 0 };
+    int writeIndex = 0;
+    int readIndex = 1;
+};
+
+/** Publication counters for an append-only ring with one writer and one reader.
+    The writer brackets each append with beginWrite()/endWrite(). The reader copies the range
+    returned by getReadableRange() and then calls getFirstIntactIndex() to find out which of the
+    copied items may have been overwritten while it was reading. Neither side ever waits.
+    getSequence() counts appends, resets and discards and, unlike getNumWritten(), never goes back. */
+class RingPublication
+{
+public:
+    struct Range
+    {
+        std::uint64_t begin = 0;
+        std::uint64_t end = 0;
+
+        int size() const noexcept { return (int) (end - begin); }
+    };
+
+    void reset() noexcept
+    {
+        pendingEnd = 0;
+        committed.store (0, std::memory_order_relaxed);
+        claimed.store (0, std::memory_order_relaxed);
+        origin.store (0, std::memory_order_release);
+        sequence.fetch_add (1, std::memory_order_release);
+    }
+
+    std::uint64_t beginWrite (int count) noexcept
+    {
+        const auto start = committed.load (std::memory_order_relaxed);
+        pendingEnd = start + (std::uint64_t) count;
+        claimed.store (pendingEnd, std::memory_order_relaxed);
+        std::atomic_thread_fence (std::memory_order_release);
+        return start;
+    }
+
+    void endWrite() noexcept
+    {
+        committed.store (pendingEnd, std::memory_order_release);
+        sequence.fetch_add (1, std::memory_order_release);
+    }
+
+    void discard() noexcept
+    {
+        origin.store (committed.load (std::memory_order_relaxed), std::memory_order_release);
+        sequence.fetch_add (1, std::memory_order_release);
+    }
+
+    std::uint64_t getNumWritten() const noexcept { return committed.load (std::memory_order_acquire); }
+    std::uint64_t getSequence() const noexcept { return sequence.load (std::memory_order_acquire); }
+
+    Range getReadableRange (int capacity) const noexcept
+    {
+        Range range;
+        range.end = committed.load (std::memory_order_acquire);
+        const auto oldest = range.end > (std::uint64_t) capacity ? range.end - (std::uint64_t) capacity : 0;
+        range.begin = std::max (oldest, origin.load (std::memory_order_acquire));
+        range.begin = std::min (range.begin, range.end);
+        return range;
+    }
+
+    std::uint64_t getFirstIntactIndex (int capacity) const noexcept
+    {
+        std::atomic_thread_fence (std::memory_order_acquire);
+        const auto claim = claimed.load (std::memory_order_relaxed);
+        return claim > (std::uint64_t) capacity ? claim - (std::uint64_t) capacity : 0;
+    }
+
+private:
+    std::atomic<std::uint64_t> committed { 0 };
+    std::atomic<std::uint64_t> claimed { 0 };
+    std::atomic<std::uint64_t> origin { 0 };
+    std::atomic<std::uint64_t> sequence { 0 };
+    std::uint64_t pendingEnd = 0;
+};
+
+/** Wait-free single-producer/single-consumer queue of multichannel audio blocks, each carrying a
+    header. Samples and headers travel through separate AbstractFifos and a header is only
+    published after its samples, so the reader never sees a block before its audio. */
+template <typename Header>
+class AudioBlockFifo
+{
+public:
+    void prepare (int numChannels, int capacitySamples, int maxBlocks)
+    {
+        samples.setSize (juce::jmax (1, numChannels), juce::jmax (1, capacitySamples) + 1, false, true, false);
+        sampleFifo.setTotalSize (samples.getNumSamples());
+        headers.assign ((size_t) juce::jmax (1, maxBlocks) + 1, {});
+        headerFifo.setTotalSize ((int) headers.size());
+    }
+
+    void reset() noexcept
+    {
+        sampleFifo.reset();
+        headerFifo.reset();
+    }
+
+    int getCapacity() const noexcept { return sampleFifo.getTotalSize() - 1; }
+
+    /** Returns false, writing nothing, when there is not room for the whole block. */
+    bool push (const float* const* channels, int numChannels, int numSamples, const Header& header) noexcept
+    {
+        if (sampleFifo.getFreeSpace() < numSamples || headerFifo.getFreeSpace() < 1)
+            return false;
+
+        int start1, size1, start2, size2;
+        sampleFifo.prepareToWrite (numSamples, start1, size1, start2, size2);
+        for (int ch = 0; ch < juce::jmin (numChannels, samples.getNumChannels()); ++ch)
+        {
+            samples.copyFrom (ch, start1, channels[ch], size1);
+            if (size2 > 0)
+                samples.copyFrom (ch, start2, channels[ch] + size1, size2);
+        }
+        sampleFifo.finishedWrite (size1 + size2);
+
+        headerFifo.prepareToWrite (1, start1, size1, start2, size2);
+        headers[(size_t) start1] = { numSamples, header };
+        headerFifo.finishedWrite (1);
+        return true;
+    }
+
+    /** Copies the next block into destination, which must hold getCapacity() samples per channel. */
+    bool pop (juce::AudioBuffer<float>& destination, int& numSamples, Header& header) noexcept
+    {
+        if (headerFifo.getNumReady() < 1)
+            return false;
+
+        int start1, size1, start2, size2;
+        headerFifo.prepareToRead (1, start1, size1, start2, size2);
+        numSamples = headers[(size_t) start1].numSamples;
+        header = headers[(size_t) start1].header;
+        headerFifo.finishedRead (1);
+
+        sampleFifo.prepareToRead (numSamples, start1, size1, start2, size2);
+        for (int ch = 0; ch < juce::jmin (destination.getNumChannels(), samples.getNumChannels()); ++ch)
+        {
+            destination.copyFrom (ch, 0, samples, ch, start1, size1);
+            if (size2 > 0)
+                destination.copyFrom (ch, size1, samples, ch, start2, size2);
+        }
+        sampleFifo.finishedRead (size1 + size2);
+        return true;
+    }
+
+private:
+    struct QueuedHeader
+    {
+        int numSamples = 0;
+        Header header {};
+    };
+
+    juce::AbstractFifo sampleFifo { 1 };
+    juce::AbstractFifo headerFifo { 1 };
+    juce::AudioBuffer<float> samples;
+    std::vector<QueuedHeader> headers;
+};
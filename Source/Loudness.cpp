@@ -0,0 +1,199 @@
+#include "Loudness.h"
+#include <cmath>
+#include <algorithm>
+
+void LoudnessHistogram::reset() noexcept
+{
+    counts.fill (0);
+    energies.fill (0.0);
+    totalBlocks = 0;
+    totalEnergy = 0.0;
+}
+
+float LoudnessHistogram::energyToLoudness (double energy) noexcept
+{
+    return -0.691f + 10.0f * (float) std::log10 (juce::jmax (1.0e-12, energy));
+}
+
+int LoudnessHistogram::getBinForLoudness (float loudness) const noexcept
+{
+    return juce::jlimit (0, numBins - 1, (int) std::floor ((loudness - absoluteGateLufs) / binWidthLu));
+}
+
+void LoudnessHistogram::addBlock (double energy) noexcept
+{
+    const float loudness = energyToLoudness (energy);
+    if (loudness <= absoluteGateLufs)
+        return;
+
+    const auto bin = (size_t) getBinForLoudness (loudness);
+    ++counts[bin];
+    energies[bin] += energy;
+    ++totalBlocks;
+    totalEnergy += energy;
+}
+
+float LoudnessHistogram::getGatedLoudness (float relativeGateLu) const noexcept
+{
+    if (totalBlocks == 0)
+        return -100.0f;
+
+    const float relativeGate = energyToLoudness (totalEnergy / (double) totalBlocks) + relativeGateLu;
+
+    std::uint64_t gatedBlocks = 0;
+    double gatedEnergy = 0.0;
+    for (int bin = getBinForLoudness (relativeGate); bin < numBins; ++bin)
+    {
+        gatedBlocks += counts[(size_t) bin];
+        gatedEnergy += energies[(size_t) bin];
+    }
+
+    if (gatedBlocks == 0)
+        return energyToLoudness (totalEnergy / (double) totalBlocks);
+
+    return energyToLoudness (gatedEnergy / (double) gatedBlocks);
+}
+
+float LoudnessHistogram::getPercentile (float gateLufs, float fraction) const noexcept
+{
+    const int firstBin = gateLufs > absoluteGateLufs ? getBinForLoudness (gateLufs) : 0;
+
+    std::uint64_t gatedBlocks = 0;
+    for (int bin = firstBin; bin < numBins; ++bin)
+        gatedBlocks += counts[(size_t) bin];
+
+    if (gatedBlocks == 0)
+        return -100.0f;
+
+    const auto rank = (std::uint64_t) std::floor ((double) (gatedBlocks - 1) * (double) fraction);
+    std::uint64_t below = 0;
+    for (int bin = firstBin; bin < numBins; ++bin)
+    {
+        const auto count = counts[(size_t) bin];
+        below += count;
+        if (count > 0 && below > rank)
+            return energyToLoudness (energies[(size_t) bin] / (double) count);
+    }
+
+    return -100.0f;
+}
+
+void LoudnessEngine::prepare (double sampleRate)
+{
+    partialSamples = juce::jmax (1, (int) std::round (sampleRate * 0.01));
+    reset();
+}
+
+void LoudnessEngine::reset() noexcept
+{
+    partialCounter = 0;
+    partialAccumulator = 0.0;
+    partials.fill (0.0);
+    partialWriteIndex = 0;
+    partialsFilled = 0;
+    gatingStepCounter = 0;
+    momentarySum = 0.0;
+    shortTermSum = 0.0;
+    momentaryLoudness = -100.0f;
+    shortTermLoudness = -100.0f;
+    resetMaxima();
+    integratedHistogram.reset();
+    rangeHistogram.reset();
+    integratedLoudness = -100.0f;
+    loudnessRange = 0.0f;
+}
+
+void LoudnessEngine::resetMaxima() noexcept
+{
+    maxMomentaryLoudness = -100.0f;
+    maxShortTermLoudness = -100.0f;
+}
+
+float LoudnessEngine::windowToLoudness (double sum, int windowSamples) noexcept
+{
+    return juce::jmax (-100.0f, LoudnessHistogram::energyToLoudness (sum / (double) windowSamples));
+}
+
+void LoudnessEngine::process (const float* const* kWeighted, const float* channelWeights, int numChannels, int numSamples) noexcept
+{
+    for (int i = 0; i < numSamples;)
+    {
+        const int segment = juce::jmin (numSamples - i, partialSamples - partialCounter);
+
+        for (int ch = 0; ch < numChannels; ++ch)
+        {
+            if (channelWeights[ch] <= 0.0f)
+                continue;
+
+            const float* samples = kWeighted[ch] + i;
+            float sum = 0.0f;
+            for (int s = 0; s < segment; ++s)
+                sum += samples[s] * samples[s];
+
+            partialAccumulator += (double) channelWeights[ch] * (double) sum;
+        }
+
+        partialCounter += segment;
+        i += segment;
+
+        if (partialCounter >= partialSamples)
+        {
+            pushPartial (partialAccumulator);
+            partialAccumulator = 0.0;
+            partialCounter = 0;
+        }
+    }
+}
+
+void LoudnessEngine::pushPartial (double energy) noexcept
+{
+    constexpr int ringSize = partialsPerShortTermWindow;
+    const auto leavingMomentary = (size_t) ((partialWriteIndex - partialsPerMomentaryWindow + ringSize) % ringSize);
+
+    momentarySum += energy - partials[leavingMomentary];
+    shortTermSum += energy - partials[(size_t) partialWriteIndex];
+    partials[(size_t) partialWriteIndex] = energy;
+    partialWriteIndex = (partialWriteIndex + 1) % ringSize;
+    partialsFilled = juce::jmin (ringSize, partialsFilled + 1);
+
+    if (partialWriteIndex == 0)
+    {
+        // Re-derive both sums once per lap so rounding in the running updates cannot accumulate.
+        shortTermSum = 0.0;
+        for (double partial : partials)
+            shortTermSum += partial;
+
+        momentarySum = 0.0;
+        for (int i = ringSize - partialsPerMomentaryWindow; i < ringSize; ++i)
+            momentarySum += partials[(size_t) i];
+    }
+
+    momentaryLoudness = windowToLoudness (momentarySum, partialsPerMomentaryWindow * partialSamples);
+    shortTermLoudness = windowToLoudness (shortTermSum, partialsPerShortTermWindow * partialSamples);
+    maxMomentaryLoudness = juce::jmax (maxMomentaryLoudness, momentaryLoudness);
+    maxShortTermLoudness = juce::jmax (maxShortTermLoudness, shortTermLoudness);
+
+    if (++gatingStepCounter >= partialsPerGatingStep)
+    {
+        gatingStepCounter = 0;
+        updateGatedStatistics();
+    }
+}
+
+void LoudnessEngine::updateGatedStatistics() noexcept
+{
+    if (partialsFilled >= partialsPerMomentaryWindow)
+    {
+        integratedHistogram.addBlock (momentarySum / (double) (partialsPerMomentaryWindow * partialSamples));
+        integratedLoudness = integratedHistogram.getGatedLoudness (-10.0f);
+    }
+
+    if (partialsFilled >= partialsPerShortTermWindow)
+        rangeHistogram.addBlock (shortTermSum / (double) (partialsPerShortTermWindow * partialSamples));
+
+    if (rangeHistogram.getNumBlocks() < 2)
+        return;
+
+    const float gate = integratedLoudness - 20.0f;
+    loudnessRange = juce::jmax (0.0f, rangeHistogram.getPercentile (gate, 0.95f) - rangeHistogram.getPercentile (gate, 0.10f));
+}
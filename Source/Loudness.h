@@ -0,0 +1,89 @@
+#pragma once
+#include <JuceHeader.h>
+#include <array>
+#include <cstdint>
+
+/** Gating-block loudness histogram at 0.1 LU resolution.
+    Each bin keeps a block count and the exact sum of the block energies, so gated means are
+    computed from real energies while the gate decisions cost O(bins) regardless of duration. */
+class LoudnessHistogram
+{
+public:
+    static constexpr float absoluteGateLufs = -70.0f;
+    static constexpr float binWidthLu = 0.1f;
+    static constexpr int numBins = 800;
+
+    void reset() noexcept;
+    void addBlock (double energy) noexcept;
+
+    std::uint64_t getNumBlocks() const noexcept { return totalBlocks; }
+
+    /** Mean loudness of the blocks above the absolute gate and above (that mean + relativeGateLu). */
+    float getGatedLoudness (float relativeGateLu) const noexcept;
+
+    /** Loudness below which the given fraction of the blocks louder than gateLufs fall. */
+    float getPercentile (float gateLufs, float fraction) const noexcept;
+
+    static float energyToLoudness (double energy) noexcept;
+
+private:
+    int getBinForLoudness (float loudness) const noexcept;
+
+    std::array<std::uint32_t, numBins> counts {};
+    std::array<double, numBins> energies {};
+    std::uint64_t totalBlocks = 0;
+    double totalEnergy = 0.0;
+};
+
+/** BS.1770 momentary, short-term and integrated loudness plus EBU Tech 3342 loudness range.
+    Weighted K-weighted channel powers are summed into 10 ms partial energies. Running sums over the last 40 and
+    300 partials give the rectangular 400 ms and 3 s windows every 10 ms, whatever the host block
+    size. Every 100 ms those windows also become a gating block (75 % overlap) and a short-term
+    block, each added to its own LoudnessHistogram so the gated statistics cover any duration. */
+class LoudnessEngine
+{
+public:
+    void prepare (double sampleRate);
+    void reset() noexcept;
+    void resetMaxima() noexcept;
+
+    /** Adds one block of K-weighted channels, each scaled by its BS.1770 channel weight (0 skips a channel). */
+    void process (const float* const* kWeighted, const float* channelWeights, int numChannels, int numSamples) noexcept;
+
+    float getMomentaryLoudness() const noexcept { return momentaryLoudness; }
+    float getShortTermLoudness() const noexcept { return shortTermLoudness; }
+    float getMaxMomentaryLoudness() const noexcept { return maxMomentaryLoudness; }
+    float getMaxShortTermLoudness() const noexcept { return maxShortTermLoudness; }
+    float getIntegratedLoudness() const noexcept { return integratedLoudness; }
+    float getLoudnessRange() const noexcept { return loudnessRange; }
+
+private:
+    static constexpr int partialsPerMomentaryWindow = 40;
+    static constexpr int partialsPerShortTermWindow = 300;
+    static constexpr int partialsPerGatingStep = 10;
+
+    void pushPartial (double energy) noexcept;
+    void updateGatedStatistics() noexcept;
+    static float windowToLoudness (double sum, int windowSamples) noexcept;
+
+    int partialSamples = 480;
+    int partialCounter = 0;
+    double partialAccumulator = 0.0;
+
+    std::array<double, partialsPerShortTermWindow> partials {};
+    int partialWriteIndex = 0;
+    int partialsFilled = 0;
+    int gatingStepCounter = 0;
+    double momentarySum = 0.0;
+    double shortTermSum = 0.0;
+
+    float momentaryLoudness = -100.0f;
+    float shortTermLoudness = -100.0f;
+    float maxMomentaryLoudness = -100.0f;
+    float maxShortTermLoudness = -100.0f;
+
+    LoudnessHistogram integratedHistogram;
+    LoudnessHistogram rangeHistogram;
+    float integratedLoudness = -100.0f;
+    float loudnessRange = 0.0f;
+};
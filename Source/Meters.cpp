@@ -285,6 +285,16 @@ bool MeterComponent::applyTheme (const MeterTheme& newTheme) noexcept
     return true;
 }
 
+bool MeterComponent::sequenceAdvanced (std::uint64_t sequence) noexcept
+{
+    if (sequenceRecorded && sequence == recordedSequence)
+        return false;
+
+    recordedSequence = sequence;
+    sequenceRecorded = true;
+    return true;
+}
+
 juce::Rectangle<float> MeterComponent::getPlotArea (juce::Rectangle<float> bounds, float headerHeight) const noexcept
 {
     bounds.removeFromTop (headerHeight);
@@ -310,6 +320,7 @@ WaveformMeter::WaveformMeter()
     presetBox.onChange = [this]
     {
         handlePresetSelection();
+        invalidateSequence();
         refreshStatusText();
         repaint();
     };
@@ -324,6 +335,7 @@ WaveformMeter::WaveformMeter()
     layoutBox.onChange = [this]
     {
         layoutMode = static_cast<LayoutMode> (layoutBox.getSelectedId());
+        invalidateSequence();
         refreshStatusText();
         repaint();
     };
@@ -337,6 +349,7 @@ WaveformMeter::WaveformMeter()
     spanBox.onChange = [this]
     {
         spanMode = static_cast<SpanMode> (spanBox.getSelectedId());
+        invalidateSequence();
         refreshStatusText();
         repaint();
     };
@@ -348,6 +361,7 @@ WaveformMeter::WaveformMeter()
     amplitudeBox.onChange = [this]
     {
         amplitudeMode = static_cast<AmplitudeMode> (amplitudeBox.getSelectedId());
+        invalidateSequence();
         refreshStatusText();
         repaint();
     };
@@ -369,6 +383,7 @@ WaveformMeter::WaveformMeter()
             else if (&button == &gridButton)
                 gridEnabled = gridButton.getToggleState();
 
+            invalidateSequence();
             refreshStatusText();
             repaint();
         };
@@ -434,6 +449,14 @@ void WaveformMeter::update (const SharedDataSnapshot& snapshot, const MeterTheme
         return;
     }
 
+    // The paths depend only on the buckets and the view settings, whose handlers invalidate the sequence;
+    // the peak, RMS and clip overlays read above still need a repaint.
+    if (! sequenceAdvanced (snapshot.waveformSequence) && hasData && ! themeChanged)
+    {
+        repaint();
+        return;
+    }
+
     hasData = false;
     leftPath.clear();
     rightPath.clear();
@@ -1476,9 +1499,38 @@ InfoPanel::InfoPanel()
     configureLink (spotifyButton, "Spotify - Given Peace", "https://open.spotify.com/artist/7jdmctUwLw7Z2z7Z7jU6o7");
     configureLink (soundcloudButton, "soundcloud.com/givenpeace", "https://soundcloud.com/givenpeace");
 
+    refreshRateLabel.setJustificationType (juce::Justification::centredLeft);
+    refreshRateLabel.setFont (juce::Font (juce::FontOptions (15.0f)));
+    addAndMakeVisible (refreshRateLabel);
+
+    for (int rate : { 30, 60, 120, 144 })
+        refreshRateBox.addItem (juce::String (rate) + " fps", rate);
+    refreshRateBox.setSelectedId (60, juce::dontSendNotification);
+    refreshRateBox.onChange = [this]
+    {
+        if (onRefreshRateChanged != nullptr && refreshRateBox.getSelectedId() > 0)
+            onRefreshRateChanged (refreshRateBox.getSelectedId());
+    };
+    addAndMakeVisible (refreshRateBox);
+
+    framePacingLabel.setJustificationType (juce::Justification::topLeft);
+    framePacingLabel.setFont (juce::Font (juce::FontOptions (13.0f)));
+    framePacingLabel.setMinimumHorizontalScale (0.8f);
+    addAndMakeVisible (framePacingLabel);
+
     updateColours();
 }
 
+void InfoPanel::setRefreshRate (int framesPerSecond)
+{
+    refreshRateBox.setSelectedId (framesPerSecond, juce::dontSendNotification);
+}
+
+void InfoPanel::setFramePacingText (const juce::String& text)
+{
+    framePacingLabel.setText (text, juce::dontSendNotification);
+}
+
 void InfoPanel::update (const SharedDataSnapshot& snapshot, const MeterTheme& newTheme)
 {
     juce::ignoreUnused (snapshot);
@@ -1544,6 +1596,13 @@ void InfoPanel::resized()
             return;
 
         loveLabel.setBounds (column.removeFromTop (24));
+        column.removeFromTop (16);
+
+        auto rateRow = column.removeFromTop (28);
+        refreshRateLabel.setBounds (rateRow.removeFromLeft (72));
+        refreshRateBox.setBounds (rateRow.removeFromLeft (110));
+        column.removeFromTop (6);
+        framePacingLabel.setBounds (column.removeFromTop (juce::jmin (54, column.getHeight())));
     };
 
     auto layoutLinks = [this] (juce::Rectangle<int> column, bool multiColumn)
@@ -1623,6 +1682,14 @@ void InfoPanel::updateColours()
     taglineLabel.setColour (juce::Label::textColourId, baseText.withAlpha (0.9f));
     loveLabel.setColour (juce::Label::textColourId, baseText.withAlpha (0.82f));
     connectLabel.setColour (juce::Label::textColourId, baseText.withAlpha (0.88f));
+    refreshRateLabel.setColour (juce::Label::textColourId, baseText.withAlpha (0.82f));
+    framePacingLabel.setColour (juce::Label::textColourId, baseText.withAlpha (0.6f));
+
+    refreshRateBox.setColour (juce::ComboBox::textColourId, theme.text.withAlpha (0.82f));
+    refreshRateBox.setColour (juce::ComboBox::outlineColourId, theme.outline.withAlpha (0.3f));
+    refreshRateBox.setColour (juce::ComboBox::backgroundColourId, theme.background.darker (0.18f));
+    refreshRateBox.setColour (juce::ComboBox::arrowColourId, theme.secondary.withAlpha (0.85f));
+    refreshRateBox.setColour (juce::ComboBox::focusedOutlineColourId, theme.secondary.withAlpha (0.9f));
 
     const auto defaultLink = baseText.brighter (0.35f);
     const auto linkColour = theme.secondary.isTransparent() ? defaultLink : theme.secondary.withAlpha (0.92f);
@@ -1646,6 +1713,103 @@ void InfoPanel::updateColours()
     setLinkColours (soundcloudButton);
 }
 
+SpectrumAnalysisControls::SpectrumAnalysisControls()
+{
+    for (auto* box : { &fftSizeBox, &windowBox, &overlapBox, &resolutionBox, &spectrogramFormatBox, &spectrogramModeBox })
+    {
+        addAndMakeVisible (*box);
+        box->setJustificationType (juce::Justification::centredLeft);
+        box->onChange = [this] { notifySettingsChanged(); };
+    }
+
+    for (int order = StftAnalyzer::minFftOrder; order <= StftAnalyzer::maxFftOrder; ++order)
+        fftSizeBox.addItem ("FFT " + juce::String (1 << order), order);
+
+    windowBox.addItem ("Hann", (int) StftAnalyzer::Window::hann);
+    windowBox.addItem ("Blackman-Harris", (int) StftAnalyzer::Window::blackmanHarris);
+    windowBox.addItem ("Flat-top", (int) StftAnalyzer::Window::flatTop);
+    windowBox.addItem ("Kaiser", (int) StftAnalyzer::Window::kaiser);
+
+    overlapBox.addItem ("50% overlap", (int) StftAnalyzer::Overlap::half);
+    overlapBox.addItem ("75% overlap", (int) StftAnalyzer::Overlap::threeQuarters);
+    overlapBox.addItem ("87.5% overlap", (int) StftAnalyzer::Overlap::sevenEighths);
+
+    resolutionBox.addItem ("Linear bins", 1);
+    resolutionBox.addItem ("Multi-resolution", 2);
+
+    spectrogramFormatBox.addItem ("8-bit dB", (int) SpectrogramFrames::Format::decibels8);
+    spectrogramFormatBox.addItem ("16-bit dB", (int) SpectrogramFrames::Format::decibels16);
+    spectrogramFormatBox.setVisible (false);
+
+    spectrogramModeBox.addItem ("Standard", 1);
+    spectrogramModeBox.addItem ("Reassigned", 2);
+    spectrogramModeBox.setVisible (false);
+
+    setSettings (settings);
+}
+
+void SpectrumAnalysisControls::resized()
+{
+    auto bounds = getLocalBounds();
+    const int spacing = 6;
+    const int numBoxes = spectrogramFormatBox.isVisible() ? 6 : 4;
+    const int comboWidth = (bounds.getWidth() - spacing * (numBoxes - 1)) / numBoxes;
+
+    for (auto* box : { &fftSizeBox, &windowBox, &overlapBox, &resolutionBox, &spectrogramFormatBox, &spectrogramModeBox })
+    {
+        box->setBounds (bounds.removeFromLeft (comboWidth).reduced (0, 2));
+        bounds.removeFromLeft (spacing);
+    }
+}
+
+void SpectrumAnalysisControls::setSettings (const SpectrumAnalysisSettings& newSettings)
+{
+    settings = newSettings;
+    fftSizeBox.setSelectedId (settings.fftOrder, juce::dontSendNotification);
+    windowBox.setSelectedId (settings.window, juce::dontSendNotification);
+    overlapBox.setSelectedId (settings.overlap, juce::dontSendNotification);
+    resolutionBox.setSelectedId (settings.multiResolution ? 2 : 1, juce::dontSendNotification);
+    spectrogramFormatBox.setSelectedId (settings.spectrogramFormat, juce::dontSendNotification);
+    spectrogramModeBox.setSelectedId (settings.reassignedSpectrogram ? 2 : 1, juce::dontSendNotification);
+}
+
+void SpectrumAnalysisControls::setShowsSpectrogramOptions (bool shouldShow)
+{
+    spectrogramFormatBox.setVisible (shouldShow);
+    spectrogramModeBox.setVisible (shouldShow);
+    resized();
+}
+
+void SpectrumAnalysisControls::applyTheme (const MeterTheme& theme)
+{
+    for (auto* box : { &fftSizeBox, &windowBox, &overlapBox, &resolutionBox, &spectrogramFormatBox, &spectrogramModeBox })
+    {
+        box->setColour (juce::ComboBox::textColourId, theme.text.withAlpha (0.82f));
+        box->setColour (juce::ComboBox::outlineColourId, theme.outline.withAlpha (0.3f));
+        box->setColour (juce::ComboBox::backgroundColourId, theme.background.darker (0.18f));
+        box->setColour (juce::ComboBox::arrowColourId, theme.secondary.withAlpha (0.85f));
+        box->setColour (juce::ComboBox::focusedOutlineColourId, theme.secondary.withAlpha (0.9f));
+    }
+}
+
+void SpectrumAnalysisControls::notifySettingsChanged()
+{
+    SpectrumAnalysisSettings newSettings;
+    newSettings.fftOrder = fftSizeBox.getSelectedId();
+    newSettings.window = windowBox.getSelectedId();
+    newSettings.overlap = overlapBox.getSelectedId();
+    newSettings.multiResolution = resolutionBox.getSelectedId() == 2;
+    newSettings.spectrogramFormat = spectrogramFormatBox.getSelectedId();
+    newSettings.reassignedSpectrogram = spectrogramModeBox.getSelectedId() == 2;
+
+    if (newSettings == settings)
+        return;
+
+    settings = newSettings;
+    if (onSettingsChanged != nullptr)
+        onSettingsChanged (settings);
+}
+
 SpectrumMeter::SpectrumMeter()
     : MeterComponent ("Spectrum")
 {
@@ -1685,10 +1849,13 @@ SpectrumMeter::SpectrumMeter()
     };
 
     configureCombo (smoothingBox,
-                    { { 0, "Off" },
-                      { 1, "Gentle" },
-                      { 2, "Heavy" } });
-    smoothingBox.setSelectedId (1, juce::dontSendNotification);
+                    { { (int) Smoothing::off,          "Off" },
+                      { (int) Smoothing::octave,       "1/1 oct" },
+                      { (int) Smoothing::third,        "1/3 oct" },
+                      { (int) Smoothing::sixth,        "1/6 oct" },
+                      { (int) Smoothing::twelfth,      "1/12 oct" },
+                      { (int) Smoothing::twentyFourth, "1/24 oct" } });
+    smoothingBox.setSelectedId ((int) Smoothing::sixth, juce::dontSendNotification);
     smoothingBox.onChange = [this]
     {
         applyProcessing();
@@ -1697,6 +1864,22 @@ SpectrumMeter::SpectrumMeter()
         repaint();
     };
 
+    configureCombo (traceBox,
+                    { { StereoStftAnalyzer::mid + 1,   "Mid" },
+                      { StereoStftAnalyzer::left + 1,  "Left" },
+                      { StereoStftAnalyzer::right + 1, "Right" },
+                      { StereoStftAnalyzer::side + 1,  "Side" } });
+    traceBox.setSelectedId (StereoStftAnalyzer::mid + 1, juce::dontSendNotification);
+    traceBox.onChange = [this]
+    {
+        peakHoldBands.clear();
+        invalidateSequence();
+        updateLegendText();
+        repaint();
+    };
+
+    addAndMakeVisible (analysisControls);
+
     addAndMakeVisible (gridButton);
     gridButton.setButtonText ("Grid");
     gridButton.setToggleState (true, juce::dontSendNotification);
@@ -1723,6 +1906,24 @@ SpectrumMeter::SpectrumMeter()
         repaint();
     };
 
+    addAndMakeVisible (longTermButton);
+    longTermButton.setButtonText ("LTAS");
+    longTermButton.setToggleState (false, juce::dontSendNotification);
+    longTermButton.onClick = [this]
+    {
+        rebuildLongTermPaths();
+        updateLegendText();
+        repaint();
+    };
+
+    addAndMakeVisible (longTermResetButton);
+    longTermResetButton.setButtonText ("Reset");
+    longTermResetButton.onClick = [this]
+    {
+        if (onLongTermResetRequested != nullptr)
+            onLongTermResetRequested();
+    };
+
     auto configureSlider = [this] (juce::Slider& slider, juce::Label& label, const juce::String& text)
     {
         addAndMakeVisible (slider);
@@ -1775,7 +1976,15 @@ void SpectrumMeter::update (const SharedDataSnapshot& snapshot, const MeterTheme
     if (themeChanged)
         updateControlColours();
 
-    bands = snapshot.spectrum;
+    // Both counters only ever increase, so their sum moves whenever either section changed.
+    if (! sequenceAdvanced (snapshot.spectrumSequence + snapshot.longTermSpectrumSequence) && ! themeChanged)
+        return;
+
+    bands = selectTrace (snapshot);
+    binFrequencies = snapshot.spectrumFrequencies;
+    longTermPower = snapshot.longTermSpectrumPower;
+    longTermVariance = snapshot.longTermSpectrumVariance;
+    longTermFrames = snapshot.longTermSpectrumFrames;
     sampleRate = snapshot.sampleRate > 0.0 ? snapshot.sampleRate : sampleRate;
     hasData = ! bands.empty();
 
@@ -1785,6 +1994,8 @@ void SpectrumMeter::update (const SharedDataSnapshot& snapshot, const MeterTheme
         peakHoldBands.clear();
         spectrumPath.clear();
         overlayPath.clear();
+        longTermPath.clear();
+        longTermSpreadPath.clear();
         legendText.clear();
         repaint();
         return;
@@ -1796,6 +2007,21 @@ void SpectrumMeter::update (const SharedDataSnapshot& snapshot, const MeterTheme
     repaint();
 }
 
+const std::vector<float>& SpectrumMeter::selectTrace (const SharedDataSnapshot& snapshot) const noexcept
+{
+    // The per-channel traces are empty when the engine only analyses the downmix.
+    const std::vector<float>* trace = &snapshot.spectrum;
+    switch (traceBox.getSelectedId() - 1)
+    {
+        case StereoStftAnalyzer::left:  trace = &snapshot.spectrumLeft; break;
+        case StereoStftAnalyzer::right: trace = &snapshot.spectrumRight; break;
+        case StereoStftAnalyzer::side:  trace = &snapshot.spectrumSide; break;
+        default: break;
+    }
+
+    return trace->empty() ? snapshot.spectrum : *trace;
+}
+
 void SpectrumMeter::resized()
 {
     auto content = getPanelContentBounds().toNearestInt();
@@ -1810,10 +2036,11 @@ void SpectrumMeter::resized()
         topRow.removeFromLeft (spacing);
     };
 
-    const int comboWidth = juce::jmax (100, (topRow.getWidth() - spacing * 5) / 6);
+    const int comboWidth = juce::jmax (90, (topRow.getWidth() - spacing * 6) / 7);
     setComboBounds (scaleBox, comboWidth);
     setComboBounds (modeBox, comboWidth);
     setComboBounds (smoothingBox, comboWidth);
+    setComboBounds (traceBox, comboWidth);
 
     auto setToggleBounds = [&] (juce::ToggleButton& button, int width)
     {
@@ -1822,10 +2049,14 @@ void SpectrumMeter::resized()
         topRow.removeFromLeft (spacing);
     };
 
-    const int toggleWidth = juce::jmax (90, (topRow.getWidth() - spacing * 2) / 3);
+    const int toggleWidth = juce::jmax (64, (topRow.getWidth() - spacing * 4) / 5);
     setToggleBounds (gridButton, toggleWidth);
     setToggleBounds (legendButton, toggleWidth);
     setToggleBounds (peakHoldButton, toggleWidth);
+    setToggleBounds (longTermButton, toggleWidth);
+    longTermResetButton.setBounds (topRow.removeFromLeft (toggleWidth).reduced (2, 4));
+
+    analysisControls.setBounds (content.removeFromTop (34).reduced (4, 0));
 
     auto sliderRow = content.removeFromTop (42);
     const int labelWidth = 64;
@@ -1859,6 +2090,8 @@ void SpectrumMeter::updateControlColours()
     setCombo (scaleBox);
     setCombo (modeBox);
     setCombo (smoothingBox);
+    setCombo (traceBox);
+    analysisControls.applyTheme (theme);
 
     auto setToggle = [this] (juce::ToggleButton& button)
     {
@@ -1870,6 +2103,10 @@ void SpectrumMeter::updateControlColours()
     setToggle (gridButton);
     setToggle (legendButton);
     setToggle (peakHoldButton);
+    setToggle (longTermButton);
+
+    longTermResetButton.setColour (juce::TextButton::buttonColourId, theme.background.darker (0.18f));
+    longTermResetButton.setColour (juce::TextButton::textColourOffId, theme.text.withAlpha (0.82f));
 
     auto setSlider = [this] (juce::Slider& slider)
     {
@@ -1902,40 +2139,33 @@ void SpectrumMeter::applyProcessing()
     }
 
     processedBands.resize ((size_t) bins);
-    if (frequencyAxis.size() != (size_t) bins)
-        frequencyAxis.resize ((size_t) bins);
+    updateFrequencyAxis (bins);
 
-    const double nyquist = sampleRate * 0.5;
-    for (int i = 0; i < bins; ++i)
-        frequencyAxis[(size_t) i] = (float) (nyquist * (double) i / juce::jmax (1, bins - 1));
-
-    std::vector<float> dbValues ((size_t) bins);
-    for (int i = 0; i < bins; ++i)
+    dbValues.resize ((size_t) bins);
+    const int smoothingId = smoothingBox.getSelectedId();
+    if (smoothingId != (int) Smoothing::off && bins > 1)
     {
-        const float magnitude = bands[(size_t) i];
-        float db = juce::Decibels::gainToDecibels (magnitude + 1.0e-9f, noiseFloorDb);
-        dbValues[(size_t) i] = db;
-    }
+        if (smoothingEdgesId != smoothingId || smoothingLowerBins.size() != (size_t) bins)
+            rebuildSmoothingEdges (smoothingId);
+
+        // Mean power over each bin's fractional-octave window, read from running sums of power.
+        powerPrefix.resize ((size_t) bins + 1);
+        powerPrefix[0] = 0.0;
+        for (int i = 0; i < bins; ++i)
+            powerPrefix[(size_t) i + 1] = powerPrefix[(size_t) i] + (double) bands[(size_t) i] * (double) bands[(size_t) i];
 
-    const float smoothingAmount = getSmoothingAmount();
-    if (smoothingAmount > 0.0f)
-    {
-        std::vector<float> smoothed ((size_t) bins);
-        const int window = juce::jlimit (1, 9, (int) std::round (smoothingAmount * 6.0f) * 2 + 1);
-        const int half = window / 2;
         for (int i = 0; i < bins; ++i)
         {
-            float sum = 0.0f;
-            int count = 0;
-            for (int j = -half; j <= half; ++j)
-            {
-                const int idx = juce::jlimit (0, bins - 1, i + j);
-                sum += dbValues[(size_t) idx];
-                ++count;
-            }
-            smoothed[(size_t) i] = sum / (float) juce::jmax (1, count);
+            const int lower = smoothingLowerBins[(size_t) i];
+            const int upper = smoothingUpperBins[(size_t) i];
+            const double power = (powerPrefix[(size_t) upper + 1] - powerPrefix[(size_t) lower]) / (double) (upper - lower + 1);
+            dbValues[(size_t) i] = juce::jmax (noiseFloorDb, (float) (10.0 * std::log10 (power + 1.0e-18)));
         }
-        dbValues.swap (smoothed);
+    }
+    else
+    {
+        for (int i = 0; i < bins; ++i)
+            dbValues[(size_t) i] = juce::Decibels::gainToDecibels (bands[(size_t) i] + 1.0e-9f, noiseFloorDb);
     }
 
     for (int i = 0; i < bins; ++i)
@@ -2018,6 +2248,44 @@ void SpectrumMeter::rebuildPaths()
             overlayPath.lineTo (makePoint (i, norm));
         }
     }
+
+    rebuildLongTermPaths();
+}
+
+void SpectrumMeter::rebuildLongTermPaths()
+{
+    longTermPath.clear();
+    longTermSpreadPath.clear();
+
+    const int bins = (int) longTermPower.size();
+    if (! longTermButton.getToggleState() || longTermFrames == 0 || bins < 2
+        || frequencyAxis.size() != (size_t) bins || longTermVariance.size() != (size_t) bins)
+        return;
+
+    // Plotted on the same tilted, floored dB scale as the live trace; the shaded band spans one
+    // standard deviation of the per-frame power either side of the mean.
+    auto powerToPoint = [this] (int index, double power)
+    {
+        const float freq = juce::jmax (frequencyAxis[(size_t) index], 1.0f);
+        const float db = (float) (10.0 * std::log10 (power + 1.0e-18)) + tiltDbPerOct * std::log2 (freq / 1000.0f);
+        const float norm = juce::jlimit (0.0f, 1.0f, (db - noiseFloorDb) / (-noiseFloorDb));
+        return juce::Point<float> (frequencyToNorm (freq), 1.0f - norm);
+    };
+
+    auto deviation = [this] (int index) { return std::sqrt ((double) juce::jmax (0.0f, longTermVariance[(size_t) index])); };
+
+    longTermPath.startNewSubPath (powerToPoint (0, longTermPower[0]));
+    longTermSpreadPath.startNewSubPath (powerToPoint (0, longTermPower[0] + deviation (0)));
+    for (int i = 1; i < bins; ++i)
+    {
+        longTermPath.lineTo (powerToPoint (i, longTermPower[(size_t) i]));
+        longTermSpreadPath.lineTo (powerToPoint (i, longTermPower[(size_t) i] + deviation (i)));
+    }
+
+    for (int i = bins; --i >= 0;)
+        longTermSpreadPath.lineTo (powerToPoint (i, juce::jmax (0.0, longTermPower[(size_t) i] - deviation (i))));
+
+    longTermSpreadPath.closeSubPath();
 }
 
 void SpectrumMeter::updateLegendText()
@@ -2026,10 +2294,13 @@ void SpectrumMeter::updateLegendText()
     items.add ("Scale " + scaleBox.getText().toUpperCase());
     items.add ("Mode " + modeBox.getText().toUpperCase());
     items.add ("Smooth " + smoothingBox.getText().toUpperCase());
+    items.add ("Trace " + traceBox.getText().toUpperCase());
     items.add (juce::String::formatted ("Tilt %+.1f dB/oct", tiltDbPerOct));
     items.add (juce::String::formatted ("Floor %0.0f dB", noiseFloorDb));
     if (peakHoldButton.getToggleState())
         items.add (juce::String::formatted ("Hold %0.1f dB/s", decayPerSecondDb));
+    if (longTermButton.getToggleState())
+        items.add ("LTAS " + juce::String ((juce::int64) longTermFrames) + " frames");
     legendText = items.joinIntoString ("  •  ");
 }
 
@@ -2057,16 +2328,48 @@ float SpectrumMeter::frequencyToNorm (float frequency) const noexcept
     return 0.0f;
 }
 
-float SpectrumMeter::getSmoothingAmount() const noexcept
+void SpectrumMeter::updateFrequencyAxis (int bins)
 {
-    switch (smoothingBox.getSelectedId())
+    const bool useBinFrequencies = binFrequencies.size() == (size_t) bins;
+    if (frequencyAxis.size() == (size_t) bins && frequencyAxisSampleRate == sampleRate
+        && (! useBinFrequencies || std::equal (binFrequencies.begin(), binFrequencies.end(), frequencyAxis.begin())))
+        return;
+
+    frequencyAxis.resize ((size_t) bins);
+    frequencyAxisSampleRate = sampleRate;
+    smoothingEdgesId = 0;
+
+    const double nyquist = sampleRate * 0.5;
+    for (int i = 0; i < bins; ++i)
+        frequencyAxis[(size_t) i] = useBinFrequencies ? binFrequencies[(size_t) i]
+                                                      : (float) (nyquist * (double) i / juce::jmax (1, bins - 1));
+}
+
+void SpectrumMeter::rebuildSmoothingEdges (int smoothingId)
+{
+    static constexpr std::array<float, 6> octaveFractions { 0.0f, 1.0f, 1.0f / 3.0f, 1.0f / 6.0f, 1.0f / 12.0f, 1.0f / 24.0f };
+    const float halfWidth = std::exp2 (0.5f * octaveFractions[(size_t) juce::jlimit (0, 5, smoothingId - 1)]);
+
+    const int bins = (int) frequencyAxis.size();
+    smoothingLowerBins.resize ((size_t) bins);
+    smoothingUpperBins.resize ((size_t) bins);
+    smoothingEdgesId = smoothingId;
+
+    // The axis is ascending, so both window edges only ever move up as the bin index does.
+    int lower = 0, upper = 0;
+    for (int i = 0; i < bins; ++i)
     {
-        case 1: return 0.35f;
-        case 2: return 0.75f;
-        default: break;
-    }
+        const float centre = frequencyAxis[(size_t) i];
+        while (lower < i && frequencyAxis[(size_t) lower] < centre / halfWidth)
+            ++lower;
 
-    return 0.0f;
+        upper = juce::jmax (upper, i);
+        while (upper + 1 < bins && frequencyAxis[(size_t) upper + 1] <= centre * halfWidth)
+            ++upper;
+
+        smoothingLowerBins[(size_t) i] = lower;
+        smoothingUpperBins[(size_t) i] = upper;
+    }
 }
 
 void SpectrumMeter::paint (juce::Graphics& g)
@@ -2108,6 +2411,9 @@ void SpectrumMeter::paint (juce::Graphics& g)
     auto comboStrip = content.removeFromTop (34.0f);
     drawStripBackground (comboStrip);
 
+    auto analysisStrip = content.removeFromTop (34.0f);
+    drawStripBackground (analysisStrip);
+
     auto sliderStrip = content.removeFromTop (42.0f);
     drawStripBackground (sliderStrip);
 
@@ -2331,6 +2637,19 @@ void SpectrumMeter::paint (juce::Graphics& g)
                 }
             }
         }
+
+        if (! longTermPath.isEmpty())
+        {
+            juce::Path spread = longTermSpreadPath;
+            spread.applyTransform (transform);
+            g.setColour (theme.tertiary.withAlpha (0.14f));
+            g.fillPath (spread);
+
+            juce::Path mean = longTermPath;
+            mean.applyTransform (transform);
+            g.setColour (theme.tertiary.withAlpha (0.85f));
+            g.strokePath (mean, juce::PathStrokeType (1.4f));
+        }
     }
 
     if (drawLegend)
@@ -2354,6 +2673,203 @@ void SpectrumMeter::paint (juce::Graphics& g)
     }
 }
 
+RtaMeter::RtaMeter()
+    : MeterComponent ("RTA")
+{
+    addAndMakeVisible (rangeBox);
+    rangeBox.setJustificationType (juce::Justification::centredLeft);
+    rangeBox.addItem ("60 dB", 60);
+    rangeBox.addItem ("90 dB", 90);
+    rangeBox.addItem ("120 dB", 120);
+    rangeBox.setSelectedId ((int) rangeDb, juce::dontSendNotification);
+    rangeBox.onChange = [this]
+    {
+        rangeDb = (float) rangeBox.getSelectedId();
+        repaint();
+    };
+
+    addAndMakeVisible (gridButton);
+    gridButton.setToggleState (true, juce::dontSendNotification);
+    gridButton.onClick = [this] { repaint(); };
+
+    addAndMakeVisible (peakHoldButton);
+    peakHoldButton.setToggleState (true, juce::dontSendNotification);
+    peakHoldButton.onClick = [this]
+    {
+        peakHoldDb.clear();
+        repaint();
+    };
+
+    updateControlColours();
+}
+
+void RtaMeter::update (const SharedDataSnapshot& snapshot, const MeterTheme& newTheme)
+{
+    const bool themeChanged = applyTheme (newTheme);
+    if (themeChanged)
+        updateControlColours();
+
+    if (! sequenceAdvanced (snapshot.meterSequence) && ! themeChanged)
+        return;
+
+    const int bands = (int) snapshot.octaveBandLevels.size();
+    if (frequencies != snapshot.octaveBandFrequencies)
+    {
+        frequencies = snapshot.octaveBandFrequencies;
+        peakHoldDb.clear();
+    }
+
+    levelsDb.resize ((size_t) bands);
+    for (int band = 0; band < bands; ++band)
+        levelsDb[(size_t) band] = juce::Decibels::gainToDecibels (snapshot.octaveBandLevels[(size_t) band], -200.0f);
+
+    const double nowSeconds = juce::Time::getMillisecondCounterHiRes() * 0.001;
+    const double delta = lastUpdateSeconds > 0.0 ? nowSeconds - lastUpdateSeconds : 0.0;
+    lastUpdateSeconds = nowSeconds;
+
+    if (peakHoldButton.getToggleState())
+    {
+        if (peakHoldDb.size() != (size_t) bands)
+            peakHoldDb.assign ((size_t) bands, -200.0f);
+
+        const float decayDb = (float) (12.0 * juce::jmax (0.0, delta));
+        for (int band = 0; band < bands; ++band)
+            peakHoldDb[(size_t) band] = juce::jmax (levelsDb[(size_t) band], peakHoldDb[(size_t) band] - decayDb);
+    }
+
+    repaint();
+}
+
+void RtaMeter::resized()
+{
+    auto topRow = getPanelContentBounds().toNearestInt().removeFromTop (34);
+    const int spacing = 6;
+    const int width = juce::jmax (90, (topRow.getWidth() - spacing * 2) / 4);
+
+    rangeBox.setBounds (topRow.removeFromLeft (width).reduced (0, 2));
+    topRow.removeFromLeft (spacing);
+    gridButton.setBounds (topRow.removeFromLeft (width).reduced (4, 2));
+    topRow.removeFromLeft (spacing);
+    peakHoldButton.setBounds (topRow.removeFromLeft (width).reduced (4, 2));
+}
+
+void RtaMeter::updateControlColours()
+{
+    rangeBox.setColour (juce::ComboBox::textColourId, theme.text.withAlpha (0.82f));
+    rangeBox.setColour (juce::ComboBox::outlineColourId, theme.outline.withAlpha (0.3f));
+    rangeBox.setColour (juce::ComboBox::backgroundColourId, theme.background.darker (0.18f));
+    rangeBox.setColour (juce::ComboBox::arrowColourId, theme.secondary.withAlpha (0.85f));
+    rangeBox.setColour (juce::ComboBox::focusedOutlineColourId, theme.secondary.withAlpha (0.9f));
+
+    for (auto* button : { &gridButton, &peakHoldButton })
+    {
+        button->setColour (juce::ToggleButton::textColourId, theme.text.withAlpha (0.75f));
+        button->setColour (juce::ToggleButton::tickColourId, theme.secondary.withAlpha (0.85f));
+        button->setColour (juce::ToggleButton::tickDisabledColourId, theme.text.withAlpha (0.3f));
+    }
+}
+
+float RtaMeter::levelToNorm (float levelDb) const noexcept
+{
+    return juce::jlimit (0.0f, 1.0f, (levelDb + rangeDb) / rangeDb);
+}
+
+juce::String RtaMeter::formatFrequency (float frequency)
+{
+    if (frequency >= 1000.0f)
+        return juce::String (frequency / 1000.0f, frequency >= 10000.0f ? 0 : 1) + "k";
+
+    return juce::String (juce::roundToInt (frequency));
+}
+
+void RtaMeter::paint (juce::Graphics& g)
+{
+    auto panel = drawPanelFrame (g);
+    auto headerBounds = getPanelHeaderBounds();
+    auto content = drawPanelHeader (g, panel);
+    const int bands = (int) levelsDb.size();
+
+    if (! headerBounds.isEmpty() && bands > 1)
+    {
+        // Adjacent base-ten band centres are 10^(0.1 * 3 / b) apart for 1/b-octave bands.
+        const int bandsPerOctave = juce::roundToInt (0.3 / std::log10 (frequencies[1] / frequencies[0]));
+        g.setColour (theme.text.withAlpha (0.68f));
+        g.setFont (juce::Font (juce::FontOptions (12.5f)));
+        g.drawFittedText ("1/" + juce::String (bandsPerOctave) + " octave  " + juce::String (bands) + " bands",
+                          headerBounds.reduced (12.0f, 6.0f).toNearestInt(), juce::Justification::centredRight, 1);
+    }
+
+    auto controlStrip = content.removeFromTop (34.0f).reduced (4.0f, 4.0f);
+    g.setColour (theme.background.withAlpha (0.12f));
+    g.fillRoundedRectangle (controlStrip, 7.0f);
+    g.setColour (theme.outline.withAlpha (0.22f));
+    g.drawRoundedRectangle (controlStrip, 7.0f, 1.0f);
+
+    auto plot = content.reduced (12.0f, 12.0f);
+    plot.removeFromLeft (50.0f);
+    plot.removeFromBottom (18.0f);
+    if (plot.isEmpty())
+        return;
+
+    g.setColour (theme.background.darker (0.25f));
+    g.fillRoundedRectangle (plot.expanded (4.0f), 8.0f);
+
+    if (bands == 0)
+    {
+        g.setColour (theme.text.withAlpha (0.5f));
+        g.setFont (juce::Font (juce::FontOptions (14.0f)));
+        g.drawFittedText ("Waiting for analysis...", plot.toNearestInt(), juce::Justification::centred, 1);
+        return;
+    }
+
+    g.setFont (juce::Font (juce::FontOptions (10.5f)));
+    if (gridButton.getToggleState())
+    {
+        const float step = rangeDb > 90.0f ? 20.0f : (rangeDb > 60.0f ? 10.0f : 6.0f);
+        for (float db = 0.0f; db >= -rangeDb; db -= step)
+        {
+            const float y = plot.getBottom() - plot.getHeight() * levelToNorm (db);
+            g.setColour (theme.text.withAlpha (db == 0.0f ? 0.35f : 0.18f));
+            g.drawLine (plot.getX(), y, plot.getRight(), y, 0.8f);
+            g.setColour (theme.text.withAlpha (0.52f));
+            g.drawFittedText (juce::String::formatted ("%0.0f dB", db), juce::Rectangle<int> ((int) plot.getX() - 54, (int) y - 8, 50, 16),
+                              juce::Justification::centredRight, 1);
+        }
+    }
+
+    const float slotWidth = plot.getWidth() / (float) bands;
+    const float barWidth = juce::jmax (1.0f, slotWidth * 0.78f);
+    const bool showHold = peakHoldButton.getToggleState() && peakHoldDb.size() == (size_t) bands;
+    const int labelEvery = slotWidth >= 28.0f ? 1 : (slotWidth >= 14.0f ? 2 : 3);
+
+    for (int band = 0; band < bands; ++band)
+    {
+        const float x = plot.getX() + slotWidth * (float) band + (slotWidth - barWidth) * 0.5f;
+        const float top = plot.getBottom() - plot.getHeight() * levelToNorm (levelsDb[(size_t) band]);
+        juce::Rectangle<float> bar (x, top, barWidth, plot.getBottom() - top);
+
+        juce::ColourGradient fill (theme.secondary.withAlpha (0.9f), bar.getX(), plot.getY(),
+                                   theme.primary.withAlpha (0.55f), bar.getX(), plot.getBottom(), false);
+        g.setGradientFill (fill);
+        g.fillRect (bar);
+
+        if (showHold)
+        {
+            const float holdY = plot.getBottom() - plot.getHeight() * levelToNorm (peakHoldDb[(size_t) band]);
+            g.setColour (theme.tertiary.withAlpha (0.9f));
+            g.drawLine (x, holdY, x + barWidth, holdY, 1.4f);
+        }
+
+        if (band % labelEvery == 0 && band < (int) frequencies.size())
+        {
+            g.setColour (theme.text.withAlpha (0.5f));
+            g.drawFittedText (formatFrequency (frequencies[(size_t) band]),
+                              juce::Rectangle<float> (x + barWidth * 0.5f - 20.0f, plot.getBottom() + 4.0f, 40.0f, 14.0f).toNearestInt(),
+                              juce::Justification::centred, 1);
+        }
+    }
+}
+
 LoudnessMeter::LoudnessMeter()
     : MeterComponent ("Loudness & Peak")
 {
@@ -2560,6 +3076,21 @@ void LoudnessMeter::update (const SharedDataSnapshot& snapshot, const MeterTheme
     maxShortTerm = snapshot.maxShortTermLufs;
     peakL = snapshot.peakLeft;
     peakR = snapshot.peakRight;
+    truePeakMax = juce::jmax (snapshot.truePeakLeft, snapshot.truePeakRight);
+    droppedSeconds = snapshot.sampleRate > 0.0 ? (double) snapshot.droppedAnalysisSamples / snapshot.sampleRate : 0.0;
+    numChannels = (int) snapshot.channels.size();
+    loudestChannelPeak = 0.0f;
+    anyChannelClipped = false;
+    for (const auto& channel : snapshot.channels)
+    {
+        truePeakMax = juce::jmax (truePeakMax, channel.truePeak);
+        anyChannelClipped = anyChannelClipped || channel.clipped;
+        if (channel.peak >= loudestChannelPeak)
+        {
+            loudestChannelPeak = channel.peak;
+            loudestChannelName = channel.name;
+        }
+    }
     clipL = snapshot.clipLeft;
     clipR = snapshot.clipRight;
     rmsFast = snapshot.rmsFast;
@@ -3043,6 +3574,14 @@ void LoudnessMeter::paint (juce::Graphics& g)
     g.setFont (juce::Font (juce::FontOptions (16.0f)));
     g.drawText ("LUFS", integratedBox.removeFromTop (24.0f), juce::Justification::centredLeft, false);
 
+    if (droppedSeconds > 0.0)
+    {
+        g.setColour (theme.warning);
+        g.setFont (juce::Font (juce::FontOptions (12.0f, juce::Font::bold)));
+        g.drawText (juce::String::formatted ("Incomplete: %0.2f s of input dropped", droppedSeconds),
+                    integratedBox.removeFromTop (18.0f), juce::Justification::centredLeft, true);
+    }
+
     auto formatLufs = [] (float value)
     {
         return (value <= -95.0f) ? juce::String ("--.- LUFS") : juce::String::formatted ("%0.1f LUFS", value);
@@ -3093,8 +3632,16 @@ void LoudnessMeter::paint (juce::Graphics& g)
         drawStat ("RMS Slow", formatDb (rmsSlow), theme.text.withAlpha (0.78f));
     }
 
-    drawStat ("Peak L", formatDb (peakL), theme.text.withAlpha (0.85f), clipL);
-    drawStat ("Peak R", formatDb (peakR), theme.text.withAlpha (0.85f), clipR);
+    if (numChannels > 2)
+    {
+        drawStat ("Peak Max (" + loudestChannelName + ")", formatDb (loudestChannelPeak), theme.text.withAlpha (0.85f), anyChannelClipped);
+    }
+    else
+    {
+        drawStat ("Peak L", formatDb (peakL), theme.text.withAlpha (0.85f), clipL);
+        drawStat ("Peak R", formatDb (peakR), theme.text.withAlpha (0.85f), clipR);
+    }
+    drawStat ("True Peak Max", formatDb (truePeakMax) + "TP", truePeakMax > 1.0f ? theme.warning : theme.text.withAlpha (0.85f));
     drawStat ("History Span", juce::String::formatted ("%0.0f s", historySeconds), theme.text.withAlpha (0.7f));
 }
 
@@ -4305,6 +4852,12 @@ void OscilloscopeMeter::update (const SharedDataSnapshot& snapshot, const MeterT
 
     oscSampleRate = snapshot.sampleRate > 0.0 ? snapshot.sampleRate : oscSampleRate;
 
+    // After the silence hold the whole buffer is flat, so one silent redraw is enough.
+    const bool settledSilence = snapshot.signalSilent && drawnSilent;
+    drawnSilent = snapshot.signalSilent;
+    if ((! sequenceAdvanced (snapshot.oscilloscopeSequence) || settledSilence) && ! themeChanged)
+        return;
+
     if (freezeEnabled && hasData)
     {
         updateStatus();
@@ -4855,7 +5408,14 @@ VuNeedleMeter::VuNeedleMeter()
 
 void VuNeedleMeter::update (const SharedDataSnapshot& snapshot, const MeterTheme& newTheme)
 {
-    applyTheme (newTheme);
+    const bool themeChanged = applyTheme (newTheme);
+
+    // The needles keep decaying after the silence hold, so only stop once both rest on the scale floor.
+    const float floorGain = juce::Decibels::decibelsToGain (floorDb);
+    const bool settledSilence = snapshot.signalSilent && juce::jmax (leftNeedle, rightNeedle) + 1.0e-6f <= floorGain;
+    if ((! sequenceAdvanced (snapshot.meterSequence) || settledSilence) && ! themeChanged)
+        return;
+
     leftNeedle = snapshot.vuNeedleL;
     rightNeedle = snapshot.vuNeedleR;
     clipL = snapshot.clipLeft;
@@ -4875,7 +5435,7 @@ void VuNeedleMeter::paint (juce::Graphics& g)
         g.setColour (theme.outline.withAlpha (0.8f));
         g.drawEllipse (bounds, 1.2f);
 
-        const float dB = juce::Decibels::gainToDecibels (gain + 1.0e-6f, -40.0f);
+        const float dB = juce::Decibels::gainToDecibels (gain + 1.0e-6f, floorDb);
         const float clamped = juce::jlimit (-20.0f, 6.0f, dB);
         const float angle = juce::jmap (clamped, -20.0f, 6.0f, juce::degreesToRadians (220.0f), juce::degreesToRadians (-40.0f));
         const juce::Point<float> centre = bounds.getCentre();
@@ -41,6 +41,9 @@ public:
 
     virtual void update (const SharedDataSnapshot& snapshot, const MeterTheme& newTheme) = 0;
 
+    /** The SharedDataSnapshot sections update() reads, so the editor copies nothing else. */
+    virtual std::uint32_t getSnapshotSections() const noexcept = 0;
+
 protected:
     static constexpr float headerSectionHeight = 36.0f;
 
@@ -51,10 +54,19 @@ protected:
     juce::Rectangle<float> drawPanelHeader (juce::Graphics& g, juce::Rectangle<float> panelBounds) const;
     const MeterTheme& getTheme() const noexcept { return theme; }
     bool applyTheme (const MeterTheme& newTheme) noexcept;
+
+    /** Records sequence and returns false when it equals the one recorded by the previous call, i.e. the
+        snapshot data this meter draws has not changed. invalidateSequence() makes the next call return true. */
+    bool sequenceAdvanced (std::uint64_t sequence) noexcept;
+    void invalidateSequence() noexcept { sequenceRecorded = false; }
     juce::Rectangle<float> getPlotArea (juce::Rectangle<float> bounds, float headerHeight = 24.0f) const noexcept;
 
     juce::String title;
     MeterTheme theme {};
+
+private:
+    std::uint64_t recordedSequence = 0;
+    bool sequenceRecorded = false;
 };
 
 class WaveformMeter : public MeterComponent
@@ -63,6 +75,7 @@ public:
     WaveformMeter();
 
     void update (const SharedDataSnapshot& snapshot, const MeterTheme& newTheme) override;
+    std::uint32_t getSnapshotSections() const noexcept override { return SharedDataSnapshot::waveformData; }
     void paint (juce::Graphics& g) override;
     void resized() override;
 
@@ -177,12 +190,22 @@ public:
     InfoPanel();
 
     void update (const SharedDataSnapshot& snapshot, const MeterTheme& newTheme) override;
+    std::uint32_t getSnapshotSections() const noexcept override { return 0; }
     void paint (juce::Graphics& g) override;
     void resized() override;
 
+    void setRefreshRate (int framesPerSecond);
+    void setOnRefreshRateChanged (std::function<void (int)> callback) { onRefreshRateChanged = std::move (callback); }
+    void setFramePacingText (const juce::String& text);
+
 private:
     void updateColours();
 
+    juce::Label refreshRateLabel { {}, "Refresh" };
+    juce::ComboBox refreshRateBox;
+    juce::Label framePacingLabel;
+    std::function<void (int)> onRefreshRateChanged;
+
     juce::Label headlineLabel;
     juce::Label taglineLabel;
     juce::Label loveLabel;
@@ -193,15 +216,47 @@ private:
     juce::HyperlinkButton soundcloudButton;
 };
 
+/** FFT size, window, overlap and resolution pickers shared by the spectrum and spectrogram panels,
+    plus the spectrogram storage precision and reassignment mode where that applies. */
+class SpectrumAnalysisControls : public juce::Component
+{
+public:
+    SpectrumAnalysisControls();
+
+    void resized() override;
+
+    void setSettings (const SpectrumAnalysisSettings& newSettings);
+    void setShowsSpectrogramOptions (bool shouldShow);
+    void applyTheme (const MeterTheme& theme);
+
+    std::function<void (const SpectrumAnalysisSettings&)> onSettingsChanged;
+
+private:
+    void notifySettingsChanged();
+
+    juce::ComboBox fftSizeBox;
+    juce::ComboBox windowBox;
+    juce::ComboBox overlapBox;
+    juce::ComboBox resolutionBox;
+    juce::ComboBox spectrogramFormatBox;
+    juce::ComboBox spectrogramModeBox;
+    SpectrumAnalysisSettings settings;
+};
+
 class SpectrumMeter : public MeterComponent
 {
 public:
     SpectrumMeter();
 
     void update (const SharedDataSnapshot& snapshot, const MeterTheme& newTheme) override;
+    std::uint32_t getSnapshotSections() const noexcept override { return SharedDataSnapshot::spectrumData | SharedDataSnapshot::longTermSpectrumData; }
     void paint (juce::Graphics& g) override;
     void resized() override;
 
+    void setAnalysisSettings (const SpectrumAnalysisSettings& newSettings) { analysisControls.setSettings (newSettings); }
+    void setOnAnalysisSettingsChanged (std::function<void (const SpectrumAnalysisSettings&)> callback) { analysisControls.onSettingsChanged = std::move (callback); }
+    void setOnLongTermResetRequested (std::function<void()> callback) { onLongTermResetRequested = std::move (callback); }
+
 private:
     enum class Scale
     {
@@ -218,27 +273,57 @@ private:
         overlay
     };
 
+    enum class Smoothing
+    {
+        off = 1,
+        octave,
+        third,
+        sixth,
+        twelfth,
+        twentyFourth
+    };
+
+    const std::vector<float>& selectTrace (const SharedDataSnapshot& snapshot) const noexcept;
     void updateControlColours();
     void rebuildPaths();
+    void rebuildLongTermPaths();
     void updateLegendText();
     float frequencyToNorm (float frequency) const noexcept;
-    float getSmoothingAmount() const noexcept;
+    void updateFrequencyAxis (int bins);
+    void rebuildSmoothingEdges (int smoothingId);
     void applyProcessing();
 
     juce::Path spectrumPath;
     juce::Path overlayPath;
+    juce::Path longTermPath;
+    juce::Path longTermSpreadPath;
     std::vector<float> bands;
     std::vector<float> processedBands;
     std::vector<float> peakHoldBands;
     std::vector<float> frequencyAxis;
+    double frequencyAxisSampleRate = 0.0;
+    std::vector<float> dbValues;
+    std::vector<double> powerPrefix;
+    std::vector<int> smoothingLowerBins;
+    std::vector<int> smoothingUpperBins;
+    int smoothingEdgesId = 0;
+    std::vector<float> binFrequencies;
+    std::vector<float> longTermPower;
+    std::vector<float> longTermVariance;
+    std::uint64_t longTermFrames = 0;
     juce::ComboBox scaleBox;
     juce::ComboBox modeBox;
     juce::ComboBox smoothingBox;
+    juce::ComboBox traceBox;
+    SpectrumAnalysisControls analysisControls;
     juce::Slider tiltSlider;
     juce::Slider floorSlider;
     juce::ToggleButton gridButton { "Grid" };
     juce::ToggleButton legendButton { "Legend" };
     juce::ToggleButton peakHoldButton { "Peak Hold" };
+    juce::ToggleButton longTermButton { "LTAS" };
+    juce::TextButton longTermResetButton { "Reset" };
+    std::function<void()> onLongTermResetRequested;
     juce::Slider decaySlider;
     juce::Label tiltLabel;
     juce::Label floorLabel;
@@ -255,6 +340,32 @@ private:
     float decayPerSecondDb = 6.0f;
 };
 
+/** Bar display of the processor's fractional-octave filter bank levels with decaying peak hold. */
+class RtaMeter : public MeterComponent
+{
+public:
+    RtaMeter();
+
+    void update (const SharedDataSnapshot& snapshot, const MeterTheme& newTheme) override;
+    std::uint32_t getSnapshotSections() const noexcept override { return SharedDataSnapshot::octaveBandData; }
+    void paint (juce::Graphics& g) override;
+    void resized() override;
+
+private:
+    void updateControlColours();
+    float levelToNorm (float levelDb) const noexcept;
+    static juce::String formatFrequency (float frequency);
+
+    std::vector<float> levelsDb;
+    std::vector<float> peakHoldDb;
+    std::vector<float> frequencies;
+    double lastUpdateSeconds = 0.0;
+    float rangeDb = 90.0f;
+    juce::ComboBox rangeBox;
+    juce::ToggleButton gridButton { "Grid" };
+    juce::ToggleButton peakHoldButton { "Peak Hold" };
+};
+
 class LoudnessMeter : public MeterComponent
 {
 public:
@@ -268,6 +379,7 @@ public:
     };
 
     void update (const SharedDataSnapshot& snapshot, const MeterTheme& newTheme) override;
+    std::uint32_t getSnapshotSections() const noexcept override { return SharedDataSnapshot::channelData | SharedDataSnapshot::loudnessHistoryData; }
     void paint (juce::Graphics& g) override;
     void resized() override;
 
@@ -294,6 +406,12 @@ private:
     float maxShortTerm = -100.0f;
     float peakL = 0.0f;
     float peakR = 0.0f;
+    float truePeakMax = 0.0f;
+    double droppedSeconds = 0.0;
+    int numChannels = 0;
+    juce::String loudestChannelName;
+    float loudestChannelPeak = 0.0f;
+    bool anyChannelClipped = false;
     bool clipL = false;
     bool clipR = false;
     std::vector<float> historyValues;
@@ -353,6 +471,7 @@ public:
     };
 
     void update (const SharedDataSnapshot& snapshot, const MeterTheme& newTheme) override;
+    std::uint32_t getSnapshotSections() const noexcept override { return SharedDataSnapshot::lissajousData; }
     void paint (juce::Graphics& g) override;
     void resized() override;
 
@@ -440,6 +559,7 @@ public:
     OscilloscopeMeter();
 
     void update (const SharedDataSnapshot& snapshot, const MeterTheme& newTheme) override;
+    std::uint32_t getSnapshotSections() const noexcept override { return SharedDataSnapshot::oscilloscopeData; }
     void paint (juce::Graphics& g) override;
     void resized() override;
 
@@ -472,6 +592,7 @@ private:
     std::vector<float> scratchBuffer;
     std::vector<float> persistenceSamples;
     bool hasData = false;
+    bool drawnSilent = false;
     bool freezeEnabled = false;
     bool persistenceEnabled = false;
     bool fillEnabled = false;
@@ -510,9 +631,12 @@ public:
     VuNeedleMeter();
 
     void update (const SharedDataSnapshot& snapshot, const MeterTheme& newTheme) override;
+    std::uint32_t getSnapshotSections() const noexcept override { return 0; }
     void paint (juce::Graphics& g) override;
 
 private:
+    static constexpr float floorDb = -40.0f;
+
     float leftNeedle = 0.0f;
     float rightNeedle = 0.0f;
     bool clipL = false;
@@ -1,9 +1,87 @@
 #include <JuceHeader.h>
 #include "PluginEditor.h"
 
+void FramePacer::setTargetRate (double framesPerSecond) noexcept
+{
+    const double period = 1.0 / juce::jlimit (1.0, 1000.0, framesPerSecond);
+    if (period == targetPeriod)
+        return;
+
+    targetPeriod = period;
+    if (lastFrame >= 0.0)
+        nextFrame = juce::jmin (nextFrame, lastFrame + targetPeriod);
+}
+
+bool FramePacer::shouldRunFrame (double timestampSeconds) noexcept
+{
+    if (lastRefresh >= 0.0)
+    {
+        const double delta = timestampSeconds - lastRefresh;
+        if (delta > 0.0 && delta < 0.1)
+            displayPeriod += 0.1 * (delta - displayPeriod);
+    }
+
+    lastRefresh = timestampSeconds;
+
+    if (windowStart < 0.0)
+        windowStart = timestampSeconds;
+    else if (timestampSeconds - windowStart >= windowSeconds)
+        closeWindow (timestampSeconds);
+
+    // Running on the refresh nearest each deadline keeps the average at the target, e.g. 60 fps on a
+    // 144 Hz display alternates two- and three-refresh intervals.
+    if (timestampSeconds < nextFrame - 0.5 * displayPeriod)
+        return false;
+
+    nextFrame = timestampSeconds - nextFrame > targetPeriod ? timestampSeconds + targetPeriod
+                                                            : nextFrame + targetPeriod;
+
+    if (lastFrame >= 0.0)
+    {
+        const double interval = timestampSeconds - lastFrame;
+        windowIntervalSum += interval;
+        windowIntervalSquares += interval * interval;
+        windowWorst = juce::jmax (windowWorst, interval);
+        ++windowIntervals;
+
+        if (interval > targetPeriod + displayPeriod)
+            ++windowLate;
+    }
+
+    lastFrame = timestampSeconds;
+    ++windowFrames;
+    return true;
+}
+
+void FramePacer::frameFinished (double workSeconds) noexcept
+{
+    windowWork += workSeconds;
+}
+
+void FramePacer::closeWindow (double timestampSeconds) noexcept
+{
+    const double elapsed = timestampSeconds - windowStart;
+    const double meanInterval = windowIntervals > 0 ? windowIntervalSum / windowIntervals : 0.0;
+    const double variance = windowIntervals > 0 ? windowIntervalSquares / windowIntervals - meanInterval * meanInterval : 0.0;
+
+    statistics.displayRateHz = displayPeriod > 0.0 ? 1.0 / displayPeriod : 0.0;
+    statistics.frameRateHz = elapsed > 0.0 ? windowFrames / elapsed : 0.0;
+    statistics.meanIntervalMs = meanInterval * 1000.0;
+    statistics.jitterMs = std::sqrt (juce::jmax (0.0, variance)) * 1000.0;
+    statistics.worstIntervalMs = windowWorst * 1000.0;
+    statistics.meanWorkMs = windowFrames > 0 ? windowWork / windowFrames * 1000.0 : 0.0;
+    statistics.lateFrames = windowLate;
+    statisticsUpdated = true;
+
+    windowStart = timestampSeconds;
+    windowFrames = windowIntervals = windowLate = 0;
+    windowIntervalSum = windowIntervalSquares = windowWorst = windowWork = 0.0;
+}
+
 MiniMetersCloneAudioProcessorEditor::MiniMetersCloneAudioProcessorEditor (MiniMetersCloneAudioProcessor& p)
     : AudioProcessorEditor (&p), audioProcessor (p)
 {
+    audioProcessor.addDisplaySubscriber();
     setLookAndFeel (&lookAndFeel);
     setResizable (true, true);
     setResizeLimits (640, 480, 1920, 1080);
@@ -20,6 +98,7 @@ MiniMetersCloneAudioProcessorEditor::MiniMetersCloneAudioProcessorEditor (MiniMe
         { "Waveform",       &waveform },
         { "Spectrogram",   &spectrogram },
         { "Spectrum",       &spectrum },
+        { "RTA",            &rta },
         { "Oscilloscope",   &oscilloscope },
         { "Loudness",       &loudness },
         { "Stereo Field",   &stereo },
@@ -91,16 +170,39 @@ MiniMetersCloneAudioProcessorEditor::MiniMetersCloneAudioProcessorEditor (MiniMe
         audioProcessor.setStereoMeterState (stored);
     });
 
+    const auto analysisSettings = audioProcessor.getSpectrumAnalysisSettings();
+    spectrum.setAnalysisSettings (analysisSettings);
+    spectrogram.setAnalysisSettings (analysisSettings);
+
+    auto onAnalysisSettingsChanged = [this] (const SpectrumAnalysisSettings& newSettings)
+    {
+        audioProcessor.setSpectrumAnalysisSettings (newSettings);
+        spectrum.setAnalysisSettings (newSettings);
+        spectrogram.setAnalysisSettings (newSettings);
+    };
+    spectrum.setOnAnalysisSettingsChanged (onAnalysisSettingsChanged);
+    spectrogram.setOnAnalysisSettingsChanged (onAnalysisSettingsChanged);
+    spectrum.setOnLongTermResetRequested ([this]
+    {
+        audioProcessor.resetLongTermSpectrum();
+    });
+
+    info.setRefreshRate (audioProcessor.getEditorRefreshRate());
+    info.setOnRefreshRateChanged ([this] (int framesPerSecond)
+    {
+        audioProcessor.setEditorRefreshRate (framesPerSecond);
+    });
+
     updateTheme();
     updateActiveModule();
 
     resized();
-    startTimerHz (30);
 }
 
 MiniMetersCloneAudioProcessorEditor::~MiniMetersCloneAudioProcessorEditor()
 {
     setLookAndFeel (nullptr);
+    audioProcessor.removeDisplaySubscriber();
 }
 
 void MiniMetersCloneAudioProcessorEditor::paint (juce::Graphics& g)
@@ -128,17 +230,48 @@ void MiniMetersCloneAudioProcessorEditor::resized()
     meterTabs.setBounds (content);
 }
 
-void MiniMetersCloneAudioProcessorEditor::timerCallback()
+void MiniMetersCloneAudioProcessorEditor::handleVBlank (double timestampSeconds)
 {
-    audioProcessor.fillSnapshot (snapshot);
-    updateTheme();
+    // Settled silence and hidden windows only need enough frames to notice a change.
+    const bool idle = snapshot.signalSilent || isOccluded();
+    framePacer.setTargetRate (idle ? kIdleRefreshHz : (double) audioProcessor.getEditorRefreshRate());
+
+    if (! framePacer.shouldRunFrame (timestampSeconds))
+        return;
 
+    const double startMs = juce::Time::getMillisecondCounterHiRes();
+    updateTheme();
     updateActiveModule();
+    framePacer.frameFinished ((juce::Time::getMillisecondCounterHiRes() - startMs) * 0.001);
+
+    if (framePacer.takeStatisticsUpdate())
+        showFramePacing();
+}
+
+bool MiniMetersCloneAudioProcessorEditor::isOccluded() const
+{
+    auto* peer = getPeer();
+    return peer == nullptr || peer->isMinimised() || ! isShowing();
+}
+
+void MiniMetersCloneAudioProcessorEditor::showFramePacing()
+{
+    const auto& stats = framePacer.getStatistics();
+    juce::String text;
+    text << "Display " << juce::roundToInt (stats.displayRateHz) << " Hz  •  "
+         << juce::String (stats.frameRateHz, 1) << " fps (target " << juce::roundToInt (framePacer.getTargetRate()) << ")\n"
+         << "Interval " << juce::String (stats.meanIntervalMs, 1) << " ms ± " << juce::String (stats.jitterMs, 1)
+         << "  •  worst " << juce::String (stats.worstIntervalMs, 1) << " ms  •  " << stats.lateFrames << " late\n"
+         << "UI work " << juce::String (stats.meanWorkMs, 2) << " ms / frame";
+    info.setFramePacingText (text);
 }
 
 void MiniMetersCloneAudioProcessorEditor::updateActiveModule()
 {
-    if (auto* activeModule = getActiveModule())
+    auto* activeModule = getActiveModule();
+    audioProcessor.fillSnapshot (snapshot, activeModule != nullptr ? activeModule->getSnapshotSections() : 0u);
+
+    if (activeModule != nullptr)
         activeModule->update (snapshot, theme);
 }
 
@@ -154,7 +287,11 @@ MeterComponent* MiniMetersCloneAudioProcessorEditor::getActiveModule() const noe
 
 void MiniMetersCloneAudioProcessorEditor::updateTheme()
 {
-    theme = createThemeForSelection();
+    const auto newTheme = createThemeForSelection();
+    if (newTheme == theme)
+        return;
+
+    theme = newTheme;
 
     meterTabs.setColour (juce::TabbedComponent::backgroundColourId, juce::Colours::transparentBlack);
     meterTabs.setColour (juce::TabbedComponent::outlineColourId, juce::Colours::transparentBlack);
@@ -188,7 +325,7 @@ MeterTheme MiniMetersCloneAudioProcessorEditor::createThemeForSelection() const
 void MiniMetersCloneAudioProcessorEditor::saveAudioHistory()
 {
     SharedDataSnapshot latest;
-    audioProcessor.fillSnapshot (latest, true);
+    audioProcessor.fillSnapshot (latest, SharedDataSnapshot::audioHistoryData);
 
     const auto& history = latest.audioHistory;
     const int totalSamples = history.getNumSamples();
@@ -2,6 +2,7 @@
 #pragma once
 #include <functional>
 #include <memory>
+#include <utility>
 #include "PluginProcessor.h"
 #include "Meters.h"
 #include "Spectrogram.h"
@@ -24,8 +25,60 @@ public:
     }
 };
 
-class MiniMetersCloneAudioProcessorEditor : public juce::AudioProcessorEditor,
-                                            private juce::Timer
+/** Picks which display refreshes run an editor frame so frames land on vblanks at the target rate on
+    average, and measures the achieved pacing over one-second windows. */
+class FramePacer
+{
+public:
+    struct Statistics
+    {
+        double displayRateHz = 0.0;
+        double frameRateHz = 0.0;
+        double meanIntervalMs = 0.0;
+        double jitterMs = 0.0;
+        double worstIntervalMs = 0.0;
+        double meanWorkMs = 0.0;
+        int lateFrames = 0;
+    };
+
+    void setTargetRate (double framesPerSecond) noexcept;
+    double getTargetRate() const noexcept { return 1.0 / targetPeriod; }
+
+    /** Called on every display refresh; returns true when this one should run a frame. */
+    bool shouldRunFrame (double timestampSeconds) noexcept;
+
+    /** Reports the message-thread time taken by the frame shouldRunFrame() just allowed. */
+    void frameFinished (double workSeconds) noexcept;
+
+    /** Returns true once after each statistics window closes. */
+    bool takeStatisticsUpdate() noexcept { return std::exchange (statisticsUpdated, false); }
+    const Statistics& getStatistics() const noexcept { return statistics; }
+
+private:
+    void closeWindow (double timestampSeconds) noexcept;
+
+    static constexpr double windowSeconds = 1.0;
+
+    double targetPeriod = 1.0 / 60.0;
+    double displayPeriod = 1.0 / 60.0;
+    double lastRefresh = -1.0;
+    double lastFrame = -1.0;
+    double nextFrame = 0.0;
+    double windowStart = -1.0;
+
+    int windowFrames = 0;
+    int windowIntervals = 0;
+    int windowLate = 0;
+    double windowIntervalSum = 0.0;
+    double windowIntervalSquares = 0.0;
+    double windowWorst = 0.0;
+    double windowWork = 0.0;
+
+    Statistics statistics;
+    bool statisticsUpdated = false;
+};
+
+class MiniMetersCloneAudioProcessorEditor : public juce::AudioProcessorEditor
 {
 public:
     explicit MiniMetersCloneAudioProcessorEditor (MiniMetersCloneAudioProcessor&);
@@ -44,6 +97,7 @@ private:
     WaveformMeter waveform;
     SpectrogramMeter spectrogram;
     SpectrumMeter spectrum;
+    RtaMeter rta;
     LoudnessMeter loudness;
     StereoMeter stereo;
     OscilloscopeMeter oscilloscope;
@@ -52,7 +106,14 @@ private:
     NotifyingTabbedComponent meterTabs { juce::TabbedButtonBar::TabsAtTop };
     std::vector<MeterComponent*> moduleComponents;
 
-    void timerCallback() override;
+    FramePacer framePacer;
+    juce::VBlankAttachment vBlankAttachment { this, [this] (double timestampSeconds) { handleVBlank (timestampSeconds); } };
+
+    static constexpr double kIdleRefreshHz = 10.0;
+
+    void handleVBlank (double timestampSeconds);
+    bool isOccluded() const;
+    void showFramePacing();
     void updateTheme();
     MeterTheme createThemeForSelection() const;
     void saveAudioHistory();
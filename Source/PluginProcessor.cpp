@@ -4,6 +4,7 @@
 #include <cmath>
 #include <algorithm>
 #include <initializer_list>
+#include <iterator>
 
 MiniMetersCloneAudioProcessor::MiniMetersCloneAudioProcessor()
 : AudioProcessor (BusesProperties()
@@ -13,149 +14,110 @@ MiniMetersCloneAudioProcessor::MiniMetersCloneAudioProcessor()
     initialiseSharedState();
 }
 
+MiniMetersCloneAudioProcessor::~MiniMetersCloneAudioProcessor()
+{
+    spectrumEngineBuilder.stopThread (1000);
+    analysisWorker.stopThread (1000);
+    discardQueuedSpectrumEngines();
+}
+
 void MiniMetersCloneAudioProcessor::prepareToPlay (double sr, int samplesPerBlock)
 {
+    spectrumEngineBuilder.stopThread (1000);
+    analysisWorker.stopThread (1000);
+
     sampleRate = (float) sr;
     setBallistics (10.0f, 300.0f);
 
     const int historySeconds = 10;
     const int historySamples = juce::jmax (1, (int) std::round (sampleRate * historySeconds));
 
-    integratedBlockSamples = juce::jmax (1, (int) std::round (sampleRate * 0.4f));
-    const int integratedBlocks = juce::jmax (1, (int) std::round (600.0f / 0.4f));
-    integratedBlockEnergies.assign ((size_t) integratedBlocks, 1.0e-9f);
-    integratedScratch.resize ((size_t) integratedBlocks);
-    integratedEnergyAccumulator = 0.0;
-    integratedSampleCounter = 0;
-    integratedWriteIndex = 0;
-    integratedFilled = 0;
-    integratedLoudness = -100.0f;
+    channelLayout = describeChannelLayout (getChannelLayoutOfBus (true, 0));
+    const int numChannels = channelLayout.numChannels;
+
+    loudnessEngine.prepare (sr);
+    droppedAnalysisSamples.store (0);
 
     loudnessHistoryIntervalSamples = juce::jmax (1, (int) std::round (sampleRate * kLoudnessHistoryIntervalSeconds));
     loudnessHistorySampleCounter = 0;
     loudnessHistoryCapacity = juce::jmax (1, (int) std::round (kLoudnessHistorySpanSeconds / kLoudnessHistoryIntervalSeconds));
-    shortTermHistoryBuffer.assign ((size_t) loudnessHistoryCapacity, -100.0f);
-    shortTermHistoryWriteIndex = 0;
-    shortTermHistoryFilled = 0;
-    shortTermScratch.resize ((size_t) loudnessHistoryCapacity);
-    loudnessRangeValue = 0.0f;
-    maxMomentaryLufs = -100.0f;
-    maxShortTermLufs = -100.0f;
+
+    discardQueuedSpectrumEngines();
+    auto initialEngine = createSpectrumEngine (getSpectrumAnalysisSettings(), sr);
+    installSpectrumEngine (initialEngine, true);
 
     {
-        const juce::SpinLock::ScopedLockType sl (shared.lock);
-        shared.audioHistory.setSize (2, historySamples, false, false, true);
+        const juce::SpinLock::ScopedLockType sl (shared.layoutLock);
+        shared.audioHistory.setSize (juce::jmax (1, numChannels), historySamples, false, false, true);
         shared.audioHistory.clear();
-        shared.writePosition = 0;
-        shared.hasWrapped = false;
+        shared.audioHistoryRing.reset();
+
+        shared.channelNames = channelLayout.channelNames;
+        shared.pairNames = channelLayout.pairNames;
 
         shared.waveformSamplesPerBucket = juce::jmax (1, historySamples / kWaveformResolution);
-        for (int ch = 0; ch < 2; ++ch)
+        shared.waveform.assign ((size_t) kWaveformDisplayChannels, {});
+        for (auto& channel : shared.waveform)
         {
-            shared.waveformMin[ch].assign ((size_t) kWaveformResolution, 0.0f);
-            shared.waveformMax[ch].assign ((size_t) kWaveformResolution, 0.0f);
-            shared.waveformCurrentMin[ch] = 1.0f;
-            shared.waveformCurrentMax[ch] = -1.0f;
-            for (int band = 0; band < 3; ++band)
-            {
-                shared.waveformBandEnergy[(size_t) ch][(size_t) band].assign ((size_t) kWaveformResolution, 0.0f);
-                shared.waveformBandAccum[(size_t) ch][(size_t) band] = 0.0f;
-            }
+            channel.minimum.assign ((size_t) kWaveformResolution, 0.0f);
+            channel.maximum.assign ((size_t) kWaveformResolution, 0.0f);
+            for (auto& band : channel.bandEnergy)
+                band.assign ((size_t) kWaveformResolution, 0.0f);
         }
-        shared.waveformWriteIndex = 0;
-        shared.waveformFilled = 0;
-        shared.waveformSampleCounter = 0;
+        shared.waveformRing.reset();
 
         shared.oscilloscopeBuffer.assign ((size_t) kOscilloscopeBufferSize, 0.0f);
-        shared.oscilloscopeWriteIndex = 0;
-        shared.oscilloscopeFilled = 0;
-
-        const auto fftSize = (int) fft.getSize();
-        const int bins = fftSize / 2;
-        const double maxSpectrogramSeconds = 3.0;
-        const int hopSamples = juce::jmax (1, fftSize / 4);
-        const int historyWidth = juce::jmax (1, (int) std::ceil (maxSpectrogramSeconds * sr / (double) hopSamples));
-        shared.spectrum.resize ((size_t) bins, 0.0f);
-        shared.spectrumAverages.resize ((size_t) bins, 0.0f);
-        shared.spectrogramHistory.setSize (bins, historyWidth, false, false, true);
-        shared.spectrogramHistory.clear();
-        shared.spectrogramWritePosition = 0;
-        shared.spectrogramWrapped = false;
-        shared.lissajousCount = 0;
-        shared.momentaryLufs = shared.shortTermLufs = -100.0f;
-        shared.integratedLufs = -100.0f;
-        shared.loudnessRange = 0.0f;
-        shared.maxMomentary = -100.0f;
-        shared.maxShortTerm = -100.0f;
-        shared.rmsFast = shared.rmsSlow = 0.0f;
-        shared.correlation = 0.0f;
-        shared.stereoWidth = 0.0f;
-        shared.vuNeedleL = shared.vuNeedleR = 0.0f;
-        shared.clippedL = shared.clippedR = false;
+        shared.oscilloscopeRing.reset();
+
         shared.loudnessHistoryInterval = sampleRate > 0.0f ? (float) loudnessHistoryIntervalSamples / sampleRate : 0.0f;
         shared.loudnessHistory.assign ((size_t) loudnessHistoryCapacity, -100.0f);
-        shared.loudnessHistoryWrite = 0;
-        shared.loudnessHistoryFilled = 0;
+        shared.loudnessHistoryRing.reset();
+
+        shared.meters.initialise ([] (MeterFrame& frame) { frame = {}; });
     }
 
-    fftSpectrumFrame.assign ((size_t) (fft.getSize() / 2), 0.0f);
-
-    fftInput.resize ((size_t) fft.getSize());
-    std::fill (fftInput.begin(), fftInput.end(), 0.0f);
-    fftScratch.resize ((size_t) fft.getSize() * 2);
-    std::fill (fftScratch.begin(), fftScratch.end(), 0.0f);
-    fftInputPos = 0;
-    fftHop = juce::jmax (1, fft.getSize() / 4);
-
-    monoScratch.setSize (1, 0);
-
-    juce::dsp::ProcessSpec spec;
-    spec.sampleRate = sr;
-    spec.maximumBlockSize = (juce::uint32) juce::jmax (1, samplesPerBlock);
-    spec.numChannels = 1;
-
-    kPreFilter.prepare (spec);
-    kHighpass.prepare (spec);
-    for (auto& filter : waveformLowFilters)
-        filter.prepare (spec);
-    for (auto& filter : waveformMidHighFilters)
-        filter.prepare (spec);
-    for (auto& filter : waveformMidLowFilters)
-        filter.prepare (spec);
-    for (auto& filter : waveformHighFilters)
-        filter.prepare (spec);
-
-    auto shelf = juce::dsp::IIR::Coefficients<float>::makeHighShelf (sampleRate, 1680.0f, 0.707f, juce::Decibels::decibelsToGain (4.0f));
-    auto highpass = juce::dsp::IIR::Coefficients<float>::makeHighPass (sampleRate, 38.0f, 0.5f);
-    auto lowBand = juce::dsp::IIR::Coefficients<float>::makeLowPass (sampleRate, kWaveformLowCrossoverHz, 0.707f);
-    auto midHigh = juce::dsp::IIR::Coefficients<float>::makeHighPass (sampleRate, kWaveformLowCrossoverHz, 0.707f);
-    auto midLow = juce::dsp::IIR::Coefficients<float>::makeLowPass (sampleRate, kWaveformHighCrossoverHz, 0.707f);
-    auto highBand = juce::dsp::IIR::Coefficients<float>::makeHighPass (sampleRate, kWaveformHighCrossoverHz, 0.707f);
-    kPreFilter.coefficients = shelf;
-    kHighpass.coefficients = highpass;
-    kPreFilter.reset ();
-    kHighpass.reset ();
+    waveformSampleCounter = 0;
     for (int ch = 0; ch < 2; ++ch)
     {
-        waveformLowFilters[(size_t) ch].coefficients = lowBand;
-        waveformMidHighFilters[(size_t) ch].coefficients = midHigh;
-        waveformMidLowFilters[(size_t) ch].coefficients = midLow;
-        waveformHighFilters[(size_t) ch].coefficients = highBand;
-        waveformLowFilters[(size_t) ch].reset ();
-        waveformMidHighFilters[(size_t) ch].reset ();
-        waveformMidLowFilters[(size_t) ch].reset ();
-        waveformHighFilters[(size_t) ch].reset ();
+        waveformCurrentMin[ch] = 1.0f;
+        waveformCurrentMax[ch] = -1.0f;
+        waveformBandAccum[(size_t) ch].fill (0.0f);
     }
 
-    momentaryEnergy = shortTermEnergy = 1.0e-9f;
+    loudnessResetRequested.store (false);
+    longTermSpectrumResetRequested.store (false);
+    longTermTransportWasPlaying = false;
+    displayAnalysisActive = false;
+
+    const int fifoCapacity = juce::jmax (samplesPerBlock * 8, (int) std::round (sr * kAnalysisMaxLagSeconds));
+    analysisFifo.prepare (numChannels, fifoCapacity, juce::jmax (512, fifoCapacity / kAnalysisMinBlockSamples));
+    analysisBuffer.setSize (juce::jmax (1, numChannels), analysisFifo.getCapacity());
+    monoScratch.setSize (1, analysisFifo.getCapacity());
+
+    kWeighting.prepare (sr, numChannels);
+    kWeightedScratch.setSize (juce::jmax (1, numChannels), analysisFifo.getCapacity());
+    waveformBands.prepare (sr, kWaveformLowCrossoverHz, kWaveformHighCrossoverHz);
+    truePeakDetector.prepare (sr, numChannels, kTruePeakOversampling);
+    octaveBands.prepare (sr, kOctaveBandsPerOctave, kOctaveBandAveragingSeconds);
+    channelPeakHold.fill (0.0f);
+    maxChannelTruePeak.fill (0.0f);
+
     rmsFastEnergy = rmsSlowEnergy = 1.0e-9f;
     vuEnergyL = vuEnergyR = 0.0f;
+    silentSamples = 0;
 
-    momentaryCoeff = std::exp (-1.0f / (0.4f * sampleRate));
-    shortTermCoeff = std::exp (-1.0f / (3.0f * sampleRate));
     rmsFastCoeff = std::exp (-1.0f / (0.3f * sampleRate));
     rmsSlowCoeff = std::exp (-1.0f / (1.0f * sampleRate));
     vuCoeff = std::exp (-1.0f / (0.3f * sampleRate));
+
+    analysisWorker.startThread();
+    spectrumEngineBuilder.startThread (juce::Thread::Priority::low);
+}
+
+void MiniMetersCloneAudioProcessor::releaseResources()
+{
+    spectrumEngineBuilder.stopThread (1000);
+    analysisWorker.stopThread (1000);
 }
 
 bool MiniMetersCloneAudioProcessor::isBusesLayoutSupported (const BusesLayout& layouts) const
@@ -163,14 +125,98 @@ bool MiniMetersCloneAudioProcessor::isBusesLayoutSupported (const BusesLayout& l
     auto in  = layouts.getMainInputChannelSet();
     auto out = layouts.getMainOutputChannelSet();
     if (in != out) return false;
-    return (in == juce::AudioChannelSet::mono() || in == juce::AudioChannelSet::stereo());
+    return in == juce::AudioChannelSet::mono()
+        || in == juce::AudioChannelSet::stereo()
+        || in == juce::AudioChannelSet::create5point0()
+        || in == juce::AudioChannelSet::create5point1()
+        || in == juce::AudioChannelSet::create7point0()
+        || in == juce::AudioChannelSet::create7point1()
+        || in == juce::AudioChannelSet::create7point1point4();
+}
+
+MiniMetersCloneAudioProcessor::ChannelLayoutInfo MiniMetersCloneAudioProcessor::describeChannelLayout (const juce::AudioChannelSet& layout)
+{
+    using Type = juce::AudioChannelSet::ChannelType;
+
+    ChannelLayoutInfo info;
+    info.numChannels = juce::jmin (layout.size(), kMaxMeterChannels);
+
+    std::array<Type, kMaxMeterChannels> types {};
+    for (int ch = 0; ch < info.numChannels; ++ch)
+    {
+        const auto type = layout.getTypeOfChannel (ch);
+        types[(size_t) ch] = type;
+        info.channelNames.add (type == Type::unknown ? juce::String (ch + 1)
+                                                     : juce::AudioChannelSet::getAbbreviatedChannelTypeName (type));
+
+        // ITU-R BS.1770 channel weights: +1.5 dB for the side surrounds, LFE left out of the sum.
+        switch (type)
+        {
+            case Type::LFE:
+            case Type::LFE2:
+                info.loudnessWeights[(size_t) ch] = 0.0f;
+                break;
+            case Type::leftSurround:
+            case Type::rightSurround:
+            case Type::leftSurroundSide:
+            case Type::rightSurroundSide:
+                info.loudnessWeights[(size_t) ch] = 1.41f;
+                break;
+            default:
+                info.loudnessWeights[(size_t) ch] = 1.0f;
+                break;
+        }
+    }
+
+    auto indexOf = [&] (Type type)
+    {
+        for (int ch = 0; ch < info.numChannels; ++ch)
+            if (types[(size_t) ch] == type)
+                return ch;
+
+        return -1;
+    };
+
+    const std::pair<Type, Type> symmetricPairs[] =
+    {
+        { Type::left, Type::right },
+        { Type::leftCentre, Type::rightCentre },
+        { Type::wideLeft, Type::wideRight },
+        { Type::leftSurround, Type::rightSurround },
+        { Type::leftSurroundSide, Type::rightSurroundSide },
+        { Type::leftSurroundRear, Type::rightSurroundRear },
+        { Type::topFrontLeft, Type::topFrontRight },
+        { Type::topSideLeft, Type::topSideRight },
+        { Type::topRearLeft, Type::topRearRight }
+    };
+
+    for (const auto& pair : symmetricPairs)
+    {
+        const int first = indexOf (pair.first);
+        const int second = indexOf (pair.second);
+        if (first >= 0 && second >= 0 && info.numPairs < (int) info.pairs.size())
+            info.pairs[(size_t) info.numPairs++] = { first, second };
+    }
+
+    if (info.numPairs == 0 && info.numChannels >= 2)
+        info.pairs[(size_t) info.numPairs++] = { 0, 1 };
+
+    for (int p = 0; p < info.numPairs; ++p)
+        info.pairNames.add (info.channelNames[info.pairs[(size_t) p][0]] + "/" + info.channelNames[info.pairs[(size_t) p][1]]);
+
+    if (info.numPairs > 0)
+    {
+        info.displayLeft = info.pairs[0][0];
+        info.displayRight = info.pairs[0][1];
+    }
+
+    return info;
 }
 
 void MiniMetersCloneAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer, juce::MidiBuffer&)
 {
-    juce::ScopedNoDenormals noDenormals;
-    const auto numCh = juce::jmin (2, buffer.getNumChannels());
-    const int  n     = buffer.getNumSamples();
+    const int numChannels = juce::jmin (buffer.getNumChannels(), channelLayout.numChannels);
+    const int n = buffer.getNumSamples();
 
     TransportInfo transportForBlock = lastTransportInfo;
     transportForBlock.hasInfo = false;
@@ -261,106 +307,164 @@ void MiniMetersCloneAudioProcessor::processBlock (juce::AudioBuffer<float>& buff
     else if (transportForBlock.hasInfo)
         lastTransportInfo = transportForBlock;
 
-    float pL = 0.0f, pR = 0.0f;
-    double accL = 0.0, accR = 0.0;
-    double midAcc = 0.0, sideAcc = 0.0;
-
-    if (monoScratch.getNumSamples() < n)
-        monoScratch.setSize (1, n, false, false, true);
+    // Before prepareToPlay, or after a failed one, there is no queue to feed.
+    const int fifoCapacity = analysisFifo.getCapacity();
+    if (fifoCapacity <= 0)
+        return;
 
-    auto* mono = monoScratch.getWritePointer (0);
-    if (numCh > 0)
-        juce::FloatVectorOperations::copy (mono, buffer.getReadPointer (0), n);
-    if (numCh > 1)
-        juce::FloatVectorOperations::add (mono, buffer.getReadPointer (1), n);
-    if (numCh > 0)
-        juce::FloatVectorOperations::multiply (mono, 1.0f / (float) numCh, n);
-
-    if (numCh >= 1)
+    std::array<const float*, kMaxMeterChannels> chunkChannels {};
+    for (int offset = 0; offset < n;)
     {
-        const float* l = buffer.getReadPointer (0);
-        for (int i = 0; i < n; ++i)
+        const int chunk = juce::jmin (n - offset, fifoCapacity);
+        for (int ch = 0; ch < numChannels; ++ch)
+            chunkChannels[(size_t) ch] = buffer.getReadPointer (ch) + offset;
+
+        while (! analysisFifo.push (chunkChannels.data(), numChannels, chunk, transportForBlock))
         {
-            const float a = std::abs (l[i]);
-            pL = (a > pL) ? (peakRiseCoeff * pL + (1.0f - peakRiseCoeff) * a)
-                          : (peakFallCoeff * pL + (1.0f - peakFallCoeff) * a);
-            accL += (double) (l[i] * l[i]);
+            // Offline renders can outrun the worker; wait for it there rather than drop audio from the measurement.
+            if (! isNonRealtime() || ! analysisWorker.isThreadRunning())
+            {
+                droppedAnalysisSamples.fetch_add ((std::uint64_t) chunk, std::memory_order_relaxed);
+                break;
+            }
+
+            juce::Thread::sleep (1);
         }
+
+        offset += chunk;
     }
-    if (numCh >= 2)
+}
+
+void MiniMetersCloneAudioProcessor::AnalysisWorker::run()
+{
+    while (! threadShouldExit())
     {
-        const float* r = buffer.getReadPointer (1);
-        for (int i = 0; i < n; ++i)
-        {
-            const float a = std::abs (r[i]);
-            pR = (a > pR) ? (peakRiseCoeff * pR + (1.0f - peakRiseCoeff) * a)
-                          : (peakFallCoeff * pR + (1.0f - peakFallCoeff) * a);
-            accR += (double) (r[i] * r[i]);
-        }
+        owner.drainAnalysisFifo();
+        wait (kAnalysisPollIntervalMs);
     }
+}
 
-    if (numCh >= 1)
-    {
-        const float* l = buffer.getReadPointer (0);
-        const float* r = numCh > 1 ? buffer.getReadPointer (1) : l;
-        constexpr double sqrtHalf = 1.0 / juce::MathConstants<double>::sqrt2;
+void MiniMetersCloneAudioProcessor::drainAnalysisFifo()
+{
+    juce::ScopedNoDenormals noDenormals;
 
-        for (int i = 0; i < n; ++i)
-        {
-            const double lv = l[i];
-            const double rv = r[i];
-            const double mid = (lv + rv) * sqrtHalf;
-            const double side = (lv - rv) * sqrtHalf;
-            midAcc += mid * mid;
-            sideAcc += side * side;
-        }
-    }
+    int numSamples = 0;
+    TransportInfo transport;
+    while (! analysisWorker.threadShouldExit() && analysisFifo.pop (analysisBuffer, numSamples, transport))
+        analyseBlock (analysisBuffer, numSamples, transport);
+}
 
-    const float midRmsBlock = n > 0 ? std::sqrt ((float) (midAcc / juce::jmax (1, n))) : 0.0f;
-    const float sideRmsBlock = n > 0 ? std::sqrt ((float) (sideAcc / juce::jmax (1, n))) : 0.0f;
+void MiniMetersCloneAudioProcessor::analyseBlock (const juce::AudioBuffer<float>& buffer, int n, const TransportInfo& transportForBlock)
+{
+    applyPendingLoudnessReset();
+    installPendingSpectrumEngine();
 
-    const float rmsBlockL = numCh >= 1 ? std::sqrt ((float) (accL / juce::jmax (1, n))) : 0.0f;
-    const float rmsBlockR = numCh >= 2 ? std::sqrt ((float) (accR / juce::jmax (1, n))) : rmsBlockL;
+    const bool displayActive = displaySubscribers.load (std::memory_order_acquire) > 0;
+    if (displayActive && ! displayAnalysisActive)
+        primeDisplayAnalysis();
+    displayAnalysisActive = displayActive;
+
+    const int numChannels = juce::jmin (buffer.getNumChannels(), channelLayout.numChannels);
+
+    if (monoScratch.getNumSamples() < n)
+        monoScratch.setSize (1, n, false, false, true);
+
+    auto* mono = monoScratch.getWritePointer (0);
+    const bool hasDisplayChannels = numChannels > juce::jmax (channelLayout.displayLeft, channelLayout.displayRight);
+    const float* left = hasDisplayChannels ? buffer.getReadPointer (channelLayout.displayLeft) : nullptr;
+    const float* right = hasDisplayChannels ? buffer.getReadPointer (channelLayout.displayRight) : nullptr;
+    const int numCh = left == nullptr ? 0 : (left == right ? 1 : 2);
+
+    BlockStatistics stats;
+    if (left != nullptr)
+        stats = AnalysisKernels::computeBlockStatistics (left, right, mono, n);
+    else
+        juce::FloatVectorOperations::clear (mono, n);
+
+    const double accL = numCh >= 1 ? stats.sumSquares[0] : 0.0;
+    const double accR = numCh >= 2 ? stats.sumSquares[1] : 0.0;
+
+    const float midRmsBlock = stats.getMidRms();
+    const float sideRmsBlock = stats.getSideRms();
+
+    const float rmsBlockL = stats.getRms (0);
+    const float rmsBlockR = numCh >= 2 ? stats.getRms (1) : rmsBlockL;
 
     const float prevRmsL = rmsL.load (std::memory_order_relaxed);
     const float prevRmsR = rmsR.load (std::memory_order_relaxed);
     rmsL.store (rmsCoeff * prevRmsL + (1.0f - rmsCoeff) * rmsBlockL, std::memory_order_relaxed);
     rmsR.store (rmsCoeff * prevRmsR + (1.0f - rmsCoeff) * rmsBlockR, std::memory_order_relaxed);
-    peakL.store (pL, std::memory_order_relaxed);
-    peakR.store (pR, std::memory_order_relaxed);
 
-    juce::dsp::AudioBlock<float> monoBlock (monoScratch);
-    juce::dsp::ProcessContextReplacing<float> monoContext (monoBlock);
-    kPreFilter.process (monoContext);
-    kHighpass.process (monoContext);
+    const float blockRiseCoeff = std::pow (peakRiseCoeff, (float) n);
+    const float blockFallCoeff = std::pow (peakFallCoeff, (float) n);
+    auto applyPeakBallistics = [blockRiseCoeff, blockFallCoeff] (std::atomic<float>& meter, float blockPeak)
+    {
+        const float previous = meter.load (std::memory_order_relaxed);
+        const float coeff = blockPeak > previous ? blockRiseCoeff : blockFallCoeff;
+        meter.store (coeff * previous + (1.0f - coeff) * blockPeak, std::memory_order_relaxed);
+    };
+    applyPeakBallistics (peakL, numCh >= 1 ? stats.getPeak (0) : 0.0f);
+    applyPeakBallistics (peakR, numCh >= 2 ? stats.getPeak (1) : 0.0f);
+
+    std::array<float, kMaxMeterChannels> channelRms {};
+    std::array<bool, kMaxMeterChannels> channelClipped {};
+    std::array<float, kMaxMeterChannels / 2> pairCorrelation {};
+    std::array<bool, kMaxMeterChannels> channelMeasured {};
+    float loudestBlockPeak = 0.0f;
+    auto storeChannelStatistics = [&] (int ch, const BlockStatistics& channelStats, int index)
+    {
+        const float previous = channelPeakHold[(size_t) ch];
+        const float blockPeak = channelStats.getPeak (index);
+        loudestBlockPeak = juce::jmax (loudestBlockPeak, blockPeak);
+        const float coeff = blockPeak > previous ? blockRiseCoeff : blockFallCoeff;
+        channelPeakHold[(size_t) ch] = coeff * previous + (1.0f - coeff) * blockPeak;
+        channelRms[(size_t) ch] = channelStats.getRms (index);
+        channelClipped[(size_t) ch] = channelStats.isClipped (index);
+        channelMeasured[(size_t) ch] = true;
+    };
 
-    const float* filteredMono = monoScratch.getReadPointer (0);
-    float monoEnergy = 0.0f;
-    for (int i = 0; i < n; ++i)
+    for (int p = 0; p < channelLayout.numPairs; ++p)
     {
-        const float sample = filteredMono[i];
-        const float sq = sample * sample;
-        monoEnergy += sq;
+        const auto& pair = channelLayout.pairs[(size_t) p];
+        if (pair[0] >= numChannels || pair[1] >= numChannels)
+            continue;
+
+        const auto pairStats = AnalysisKernels::computeBlockStatistics (buffer.getReadPointer (pair[0]), buffer.getReadPointer (pair[1]), nullptr, n);
+        storeChannelStatistics (pair[0], pairStats, 0);
+        storeChannelStatistics (pair[1], pairStats, 1);
+        pairCorrelation[(size_t) p] = pairStats.getCorrelation();
+    }
 
-        if (integratedBlockSamples > 0)
-        {
-            integratedEnergyAccumulator += sq;
-            if (++integratedSampleCounter >= integratedBlockSamples)
-            {
-                const float avgEnergy = (float) (integratedEnergyAccumulator / (double) integratedBlockSamples);
-                pushIntegratedBlock (avgEnergy);
-                integratedEnergyAccumulator = 0.0;
-                integratedSampleCounter = 0;
-            }
-        }
+    for (int ch = 0; ch < numChannels; ++ch)
+    {
+        if (channelMeasured[(size_t) ch])
+            continue;
+
+        const float* samples = buffer.getReadPointer (ch);
+        storeChannelStatistics (ch, AnalysisKernels::computeBlockStatistics (samples, samples, nullptr, n), 0);
+    }
+
+    const int silenceHoldSamples = (int) (kSilenceHoldSeconds * sampleRate);
+    silentSamples = loudestBlockPeak < kSilenceThreshold ? juce::jmin (silenceHoldSamples, silentSamples + n) : 0;
+
+    std::array<float, kMaxMeterChannels> blockTruePeak {};
+    if (numChannels > 0)
+        truePeakDetector.process (buffer.getArrayOfReadPointers(), numChannels, n, blockTruePeak.data());
+
+    for (int ch = 0; ch < numChannels; ++ch)
+    {
+        maxChannelTruePeak[(size_t) ch] = juce::jmax (maxChannelTruePeak[(size_t) ch], blockTruePeak[(size_t) ch]);
+        channelClipped[(size_t) ch] = channelClipped[(size_t) ch] || blockTruePeak[(size_t) ch] > 1.0f;
     }
-    if (n > 0)
-        monoEnergy /= (float) n;
 
-    const float blockMomentaryCoeff = std::pow (momentaryCoeff, (float) n);
-    const float blockShortCoeff     = std::pow (shortTermCoeff, (float) n);
-    momentaryEnergy = blockMomentaryCoeff * momentaryEnergy + (1.0f - blockMomentaryCoeff) * monoEnergy;
-    shortTermEnergy = blockShortCoeff * shortTermEnergy + (1.0f - blockShortCoeff) * monoEnergy;
+    if (kWeightedScratch.getNumSamples() < n || kWeightedScratch.getNumChannels() < numChannels)
+        kWeightedScratch.setSize (juce::jmax (1, numChannels), n, false, false, true);
+
+    if (numChannels > 0)
+    {
+        kWeighting.process (buffer.getArrayOfReadPointers(), kWeightedScratch.getArrayOfWritePointers(), numChannels, n);
+        loudnessEngine.process (kWeightedScratch.getArrayOfReadPointers(), channelLayout.loudnessWeights.data(), numChannels, n);
+    }
 
     const float blockFastCoeff = std::pow (rmsFastCoeff, (float) n);
     const float blockSlowCoeff = std::pow (rmsSlowCoeff, (float) n);
@@ -372,59 +476,33 @@ void MiniMetersCloneAudioProcessor::processBlock (juce::AudioBuffer<float>& buff
     vuEnergyL = blockVuCoeff * vuEnergyL + (1.0f - blockVuCoeff) * rmsBlockL;
     vuEnergyR = blockVuCoeff * vuEnergyR + (1.0f - blockVuCoeff) * rmsBlockR;
 
-    float corr = 0.0f;
-    if (numCh == 2)
-    {
-        const float* l = buffer.getReadPointer (0);
-        const float* r = buffer.getReadPointer (1);
-        double dot = 0.0;
-        double magLSq = 0.0;
-        double magRSq = 0.0;
-        for (int i = 0; i < n; ++i)
-        {
-            const double lv = l[i];
-            const double rv = r[i];
-            dot += lv * rv;
-            magLSq += lv * lv;
-            magRSq += rv * rv;
-        }
-        const float magL = std::sqrt ((float) magLSq);
-        const float magR = std::sqrt ((float) magRSq);
-        if (magL > 1.0e-9f && magR > 1.0e-9f)
-            corr = juce::jlimit (-1.0f, 1.0f, (float) (dot / (magL * magR)));
-
-    }
+    const float corr = numCh == 2 ? stats.getCorrelation() : 0.0f;
 
     const float stereoWidth = juce::jlimit (0.0f, 1.0f, 0.5f * (1.0f - corr));
     const float balanceDb = juce::jlimit (-24.0f, 24.0f,
                                           juce::Decibels::gainToDecibels (rmsBlockR + 1.0e-6f, -80.0f)
                                           - juce::Decibels::gainToDecibels (rmsBlockL + 1.0e-6f, -80.0f));
 
-    const float momentaryLufs = monoEnergy > 0.0f ? -0.691f + 10.0f * std::log10 (momentaryEnergy + 1.0e-12f) : -100.0f;
-    const float shortTermLufs = monoEnergy > 0.0f ? -0.691f + 10.0f * std::log10 (shortTermEnergy + 1.0e-12f) : -100.0f;
-    maxMomentaryLufs = juce::jmax (maxMomentaryLufs, momentaryLufs);
-    maxShortTermLufs = juce::jmax (maxShortTermLufs, shortTermLufs);
+    const float momentaryLufs = loudnessEngine.getMomentaryLoudness();
+    const float shortTermLufs = loudnessEngine.getShortTermLoudness();
 
     loudnessHistorySampleCounter += n;
     int historyUpdates = 0;
     while (loudnessHistorySampleCounter >= loudnessHistoryIntervalSamples)
     {
         loudnessHistorySampleCounter -= loudnessHistoryIntervalSamples;
-        pushShortTermHistoryValue (shortTermLufs);
         ++historyUpdates;
     }
-    if (historyUpdates > 0)
-        updateLoudnessRange();
 
     const float rmsFastValue = std::sqrt (juce::jmax (1.0e-12f, rmsFastEnergy));
     const float rmsSlowValue = std::sqrt (juce::jmax (1.0e-12f, rmsSlowEnergy));
 
     std::array<juce::Point<float>, 512> lissa {};
     int lissaCount = 0;
-    if (numCh >= 1)
+    if (displayActive && numCh >= 1)
     {
-        const float* l = buffer.getReadPointer (0);
-        const float* r = numCh > 1 ? buffer.getReadPointer (1) : nullptr;
+        const float* l = left;
+        const float* r = numCh > 1 ? right : nullptr;
         const int step = juce::jmax (1, n / (int) lissa.size());
         for (int i = 0; i < n && lissaCount < (int) lissa.size(); i += step)
         {
@@ -434,372 +512,249 @@ void MiniMetersCloneAudioProcessor::processBlock (juce::AudioBuffer<float>& buff
         }
     }
 
-    bool clippedL = juce::FloatVectorOperations::findMaximum (buffer.getReadPointer (0), n) >= 0.999f
-                    || juce::FloatVectorOperations::findMinimum (buffer.getReadPointer (0), n) <= -0.999f;
-    bool clippedR = numCh > 1 && (juce::FloatVectorOperations::findMaximum (buffer.getReadPointer (1), n) >= 0.999f
-                                  || juce::FloatVectorOperations::findMinimum (buffer.getReadPointer (1), n) <= -0.999f);
+    const bool clippedL = numCh >= 1 && channelClipped[(size_t) channelLayout.displayLeft];
+    const bool clippedR = numCh >= 2 && channelClipped[(size_t) channelLayout.displayRight];
 
-    bool spectrumFrameUpdated = false;
-    const float* monoForFft = monoScratch.getReadPointer (0);
-    for (int i = 0; i < n; ++i)
+    if (shared.audioHistory.getNumSamples() > 0 && numChannels > 0 && n > 0)
     {
-        fftInput[(size_t) fftInputPos++] = monoForFft[i];
-        if (fftInputPos >= fft.getSize())
-        {
-            auto* scratch = fftScratch.data();
-            std::copy (fftInput.begin(), fftInput.end(), scratch);
-            window.multiplyWithWindowingTable (scratch, (size_t) fft.getSize());
-            fft.performRealOnlyForwardTransform (scratch);
+        const int totalSamples = shared.audioHistory.getNumSamples();
+        const int toWrite = juce::jmin (n, totalSamples);
+        const auto start = shared.audioHistoryRing.beginWrite (toWrite);
 
-            const int bins = fft.getSize() / 2;
-            if (fftSpectrumFrame.size() != (size_t) bins)
-                fftSpectrumFrame.assign ((size_t) bins, 0.0f);
-
-            auto* spectrumFrameData = fftSpectrumFrame.data();
-            for (int bin = 0; bin < bins; ++bin)
+        for (int ch = 0; ch < juce::jmin (numChannels, shared.audioHistory.getNumChannels()); ++ch)
+        {
+            const float* src = buffer.getReadPointer (ch) + (n - toWrite);
+            int remaining = toWrite;
+            int destPos = (int) (start % (std::uint64_t) totalSamples);
+            while (remaining > 0)
             {
-                const float re = scratch[bin * 2];
-                const float im = scratch[bin * 2 + 1];
-                const float mag = std::sqrt (re * re + im * im) / (float) fft.getSize();
-                spectrumFrameData[(size_t) bin] = mag;
+                const int space = totalSamples - destPos;
+                const int toCopy = juce::jmin (space, remaining);
+                shared.audioHistory.copyFrom (ch, destPos, src, toCopy);
+                src += toCopy;
+                destPos = (destPos + toCopy) % totalSamples;
+                remaining -= toCopy;
             }
-
-            spectrumFrameUpdated = true;
-
-            std::rotate (fftInput.begin(), fftInput.begin() + (fft.getSize() - fftHop), fftInput.end());
-            fftInputPos = fftHop;
         }
+
+        shared.audioHistoryRing.endWrite();
     }
 
+    if (displayActive && shared.waveformSamplesPerBucket > 0 && ! shared.waveform.empty() && numCh > 0)
     {
-        const juce::SpinLock::ScopedLockType sl (shared.lock);
+        const int samplesPerBucket = shared.waveformSamplesPerBucket;
+        const int bucketCapacity = (int) shared.waveform[0].minimum.size();
+        const int bucketsCompleted = (waveformSampleCounter + n) / samplesPerBucket;
+
+        // Blocks that only add to the current bucket publish nothing, so the sequence stays put.
+        std::uint64_t bucketIndex = 0;
+        if (bucketsCompleted > 0)
+            bucketIndex = shared.waveformRing.beginWrite (bucketsCompleted);
 
-        if (shared.audioHistory.getNumSamples() > 0)
+        for (int i = 0; i < n;)
         {
-            const int totalSamples = shared.audioHistory.getNumSamples();
-            const int prevWrite = shared.writePosition;
-            for (int ch = 0; ch < numCh; ++ch)
-            {
-                const float* src = buffer.getReadPointer (ch);
-                int remaining = n;
-                int destPos = shared.writePosition;
-                while (remaining > 0)
-                {
-                    const int space = totalSamples - destPos;
-                    const int toCopy = juce::jmin (space, remaining);
-                    shared.audioHistory.copyFrom (ch, destPos, src, toCopy);
-                    src += toCopy;
-                    destPos = (destPos + toCopy) % totalSamples;
-                    remaining -= toCopy;
-                }
-            }
+            const int segment = juce::jmin (n - i, samplesPerBucket - waveformSampleCounter);
 
-            shared.writePosition = (shared.writePosition + n) % shared.audioHistory.getNumSamples();
-            if (! shared.hasWrapped && prevWrite + n >= totalSamples)
-                shared.hasWrapped = true;
-        }
+            waveformCurrentMin[0] = juce::jmin (waveformCurrentMin[0], juce::FloatVectorOperations::findMinimum (left + i, segment));
+            waveformCurrentMax[0] = juce::jmax (waveformCurrentMax[0], juce::FloatVectorOperations::findMaximum (left + i, segment));
+            waveformCurrentMin[1] = juce::jmin (waveformCurrentMin[1], juce::FloatVectorOperations::findMinimum (right + i, segment));
+            waveformCurrentMax[1] = juce::jmax (waveformCurrentMax[1], juce::FloatVectorOperations::findMaximum (right + i, segment));
+            waveformBands.process (left + i, right + i, segment, waveformBandAccum);
 
-        if (shared.waveformSamplesPerBucket > 0 && ! shared.waveformMin[0].empty())
-        {
-            auto* leftPtr = numCh > 0 ? buffer.getReadPointer (0) : nullptr;
-            auto* rightPtr = numCh > 1 ? buffer.getReadPointer (1) : leftPtr;
-
-            int bucketIndex = shared.waveformWriteIndex;
-            int filled = shared.waveformFilled;
-            int sampleCounter = shared.waveformSampleCounter;
-            float currentMinL = shared.waveformCurrentMin[0];
-            float currentMaxL = shared.waveformCurrentMax[0];
-            float currentMinR = shared.waveformCurrentMin[1];
-            float currentMaxR = shared.waveformCurrentMax[1];
-            auto& bandAccumL = shared.waveformBandAccum[0];
-            auto& bandAccumR = shared.waveformBandAccum[1];
-
-            const int bucketCapacity = (int) shared.waveformMin[0].size();
-
-            for (int i = 0; i < n; ++i)
+            i += segment;
+            waveformSampleCounter += segment;
+
+            if (waveformSampleCounter >= samplesPerBucket)
             {
-                const float sampleL = leftPtr != nullptr ? leftPtr[i] : 0.0f;
-                const float sampleR = rightPtr != nullptr ? rightPtr[i] : sampleL;
-
-                currentMinL = juce::jmin (currentMinL, sampleL);
-                currentMaxL = juce::jmax (currentMaxL, sampleL);
-                currentMinR = juce::jmin (currentMinR, sampleR);
-                currentMaxR = juce::jmax (currentMaxR, sampleR);
-
-                const float lowL = waveformLowFilters[0].processSample (sampleL);
-                float midL = waveformMidHighFilters[0].processSample (sampleL);
-                midL = waveformMidLowFilters[0].processSample (midL);
-                const float highL = waveformHighFilters[0].processSample (sampleL);
-                bandAccumL[0] += lowL * lowL;
-                bandAccumL[1] += midL * midL;
-                bandAccumL[2] += highL * highL;
-
-                const float lowR = waveformLowFilters[1].processSample (sampleR);
-                float midR = waveformMidHighFilters[1].processSample (sampleR);
-                midR = waveformMidLowFilters[1].processSample (midR);
-                const float highR = waveformHighFilters[1].processSample (sampleR);
-                bandAccumR[0] += lowR * lowR;
-                bandAccumR[1] += midR * midR;
-                bandAccumR[2] += highR * highR;
-
-                if (++sampleCounter >= shared.waveformSamplesPerBucket)
+                const auto slot = (size_t) (bucketIndex++ % (std::uint64_t) bucketCapacity);
+                const float invSamples = 1.0f / (float) samplesPerBucket;
+
+                for (int ch = 0; ch < kWaveformDisplayChannels; ++ch)
                 {
-                    shared.waveformMin[0][(size_t) bucketIndex] = currentMinL;
-                    shared.waveformMax[0][(size_t) bucketIndex] = currentMaxL;
-                    shared.waveformMin[1][(size_t) bucketIndex] = currentMinR;
-                    shared.waveformMax[1][(size_t) bucketIndex] = currentMaxR;
+                    auto& channel = shared.waveform[(size_t) ch];
+                    channel.minimum[slot] = waveformCurrentMin[ch];
+                    channel.maximum[slot] = waveformCurrentMax[ch];
+                    waveformCurrentMin[ch] = 1.0f;
+                    waveformCurrentMax[ch] = -1.0f;
 
-                    const float invSamples = 1.0f / (float) shared.waveformSamplesPerBucket;
                     for (int band = 0; band < 3; ++band)
                     {
-                        const float bandRmsLeft = std::sqrt (juce::jmax (0.0f, bandAccumL[(size_t) band] * invSamples));
-                        const float bandRmsRight = std::sqrt (juce::jmax (0.0f, bandAccumR[(size_t) band] * invSamples));
-                        shared.waveformBandEnergy[0][(size_t) band][(size_t) bucketIndex] = bandRmsLeft;
-                        shared.waveformBandEnergy[1][(size_t) band][(size_t) bucketIndex] = bandRmsRight;
-                        bandAccumL[(size_t) band] = 0.0f;
-                        bandAccumR[(size_t) band] = 0.0f;
+                        auto& accum = waveformBandAccum[(size_t) ch][(size_t) band];
+                        channel.bandEnergy[(size_t) band][slot] = std::sqrt (juce::jmax (0.0f, accum * invSamples));
+                        accum = 0.0f;
                     }
-
-                    bucketIndex = (bucketIndex + 1) % bucketCapacity;
-                    filled = juce::jmin (bucketCapacity, filled + 1);
-                    sampleCounter = 0;
-                    currentMinL = 1.0f;
-                    currentMaxL = -1.0f;
-                    currentMinR = 1.0f;
-                    currentMaxR = -1.0f;
                 }
-            }
 
-            shared.waveformWriteIndex = bucketIndex;
-            shared.waveformFilled = filled;
-            shared.waveformSampleCounter = sampleCounter;
-            shared.waveformCurrentMin[0] = currentMinL;
-            shared.waveformCurrentMax[0] = currentMaxL;
-            shared.waveformCurrentMin[1] = currentMinR;
-            shared.waveformCurrentMax[1] = currentMaxR;
+                waveformSampleCounter = 0;
+            }
         }
 
-        if (! shared.oscilloscopeBuffer.empty())
-        {
-            auto* leftPtr = numCh > 0 ? buffer.getReadPointer (0) : nullptr;
-            auto* rightPtr = numCh > 1 ? buffer.getReadPointer (1) : leftPtr;
-
-            const int oscSize = (int) shared.oscilloscopeBuffer.size();
-            int oscIndex = shared.oscilloscopeWriteIndex;
-            int oscFilled = shared.oscilloscopeFilled;
+        if (bucketsCompleted > 0)
+            shared.waveformRing.endWrite();
+    }
 
-            for (int i = 0; i < n; ++i)
-            {
-                const float sampleL = leftPtr != nullptr ? leftPtr[i] : 0.0f;
-                const float sampleR = rightPtr != nullptr ? rightPtr[i] : sampleL;
-                shared.oscilloscopeBuffer[(size_t) oscIndex] = 0.5f * (sampleL + sampleR);
-                oscIndex = (oscIndex + 1) % oscSize;
-                oscFilled = juce::jmin (oscSize, oscFilled + 1);
-            }
+    if (displayActive && ! shared.oscilloscopeBuffer.empty() && numCh > 0 && n > 0)
+    {
+        const float* leftPtr = left;
+        const float* rightPtr = right;
 
-            shared.oscilloscopeWriteIndex = oscIndex;
-            shared.oscilloscopeFilled = oscFilled;
-        }
+        const int oscSize = (int) shared.oscilloscopeBuffer.size();
+        const int toWrite = juce::jmin (n, oscSize);
+        const int offset = n - toWrite;
+        int oscIndex = (int) (shared.oscilloscopeRing.beginWrite (toWrite) % (std::uint64_t) oscSize);
 
-        if (spectrumFrameUpdated)
+        for (int i = offset; i < n; ++i)
         {
-            shared.spectrum = fftSpectrumFrame;
-            if (shared.spectrumAverages.size() != fftSpectrumFrame.size())
-                shared.spectrumAverages.resize (fftSpectrumFrame.size(), 0.0f);
-            const float smoothing = 0.6f;
-            for (size_t i = 0; i < fftSpectrumFrame.size(); ++i)
-                shared.spectrumAverages[i] = smoothing * shared.spectrumAverages[i] + (1.0f - smoothing) * fftSpectrumFrame[i];
-
-            if (shared.spectrogramHistory.getNumSamples() > 0)
-            {
-                const int bins = juce::jmin ((int) fftSpectrumFrame.size(), shared.spectrogramHistory.getNumChannels());
-                for (int bin = 0; bin < bins; ++bin)
-                    shared.spectrogramHistory.setSample (bin, shared.spectrogramWritePosition, fftSpectrumFrame[(size_t) bin]);
-
-                shared.spectrogramWritePosition = (shared.spectrogramWritePosition + 1) % shared.spectrogramHistory.getNumSamples();
-                if (shared.spectrogramWritePosition == 0)
-                    shared.spectrogramWrapped = true;
-            }
+            shared.oscilloscopeBuffer[(size_t) oscIndex] = 0.5f * (leftPtr[i] + rightPtr[i]);
+            oscIndex = (oscIndex + 1) % oscSize;
         }
 
-        shared.lissajousCount = lissaCount;
-        if (lissaCount > 0)
-            std::copy (lissa.begin(), lissa.begin() + lissaCount, shared.lissajousPoints.begin());
-
-        shared.momentaryLufs = momentaryLufs;
-        shared.shortTermLufs = shortTermLufs;
-        shared.integratedLufs = integratedLoudness;
-        shared.loudnessRange = loudnessRangeValue;
-        shared.maxMomentary = maxMomentaryLufs;
-        shared.maxShortTerm = maxShortTermLufs;
-        shared.rmsFast = rmsFastValue;
-        shared.rmsSlow = rmsSlowValue;
-        shared.correlation = corr;
-        shared.stereoWidth = stereoWidth;
-        shared.leftRms = rmsBlockL;
-        shared.rightRms = rmsBlockR;
-        shared.midRms = midRmsBlock;
-        shared.sideRms = sideRmsBlock;
-        shared.balanceDb = balanceDb;
-        shared.vuNeedleL = vuEnergyL;
-        shared.vuNeedleR = vuEnergyR;
-        shared.clippedL = clippedL;
-        shared.clippedR = clippedR;
-        shared.transport = transportForBlock;
-
-        if (historyUpdates > 0 && ! shared.loudnessHistory.empty())
-        {
-            const int capacity = (int) shared.loudnessHistory.size();
-            for (int i = 0; i < historyUpdates; ++i)
-            {
-                shared.loudnessHistory[(size_t) shared.loudnessHistoryWrite] = shortTermLufs;
-                shared.loudnessHistoryWrite = (shared.loudnessHistoryWrite + 1) % capacity;
-                shared.loudnessHistoryFilled = juce::jmin (capacity, shared.loudnessHistoryFilled + 1);
-            }
-        }
+        shared.oscilloscopeRing.endWrite();
     }
-}
 
-float MiniMetersCloneAudioProcessor::energyToLoudness (float energy) noexcept
-{
-    return -0.691f + 10.0f * std::log10 (juce::jmax (1.0e-12f, energy));
-}
-
-void MiniMetersCloneAudioProcessor::pushIntegratedBlock (float energy)
-{
-    if (integratedBlockEnergies.empty())
-        return;
+    if (displayActive)
+        octaveBands.process (mono, n);
 
-    energy = juce::jmax (1.0e-12f, energy);
-    const size_t capacity = integratedBlockEnergies.size();
-    integratedBlockEnergies[integratedWriteIndex] = energy;
-    integratedWriteIndex = (integratedWriteIndex + 1) % capacity;
-    integratedFilled = juce::jmin (capacity, integratedFilled + 1);
+    // The long-term average restarts on request and whenever the host transport starts playing.
+    const bool transportPlaying = transportForBlock.hasInfo && transportForBlock.isPlaying;
+    if (longTermSpectrumResetRequested.exchange (false, std::memory_order_acquire)
+        || (transportPlaying && ! longTermTransportWasPlaying))
+        spectrumEngine->longTerm.reset();
+    longTermTransportWasPlaying = transportPlaying;
 
-    updateIntegratedMetrics();
-}
+    analyseSpectrum (left, right, mono, n, displayActive);
 
-void MiniMetersCloneAudioProcessor::updateIntegratedMetrics()
-{
-    if (integratedFilled == 0 || integratedBlockEnergies.empty())
+    if (historyUpdates > 0 && ! shared.loudnessHistory.empty())
     {
-        integratedLoudness = -100.0f;
-        updateLoudnessRange();
-        return;
-    }
-
-    const size_t capacity = integratedBlockEnergies.size();
-    const size_t count = integratedFilled;
-    const size_t start = (integratedWriteIndex + capacity - count) % capacity;
+        const int capacity = (int) shared.loudnessHistory.size();
+        const int toWrite = juce::jmin (historyUpdates, capacity);
+        const auto start = shared.loudnessHistoryRing.beginWrite (toWrite);
+        for (int i = 0; i < toWrite; ++i)
+            shared.loudnessHistory[(size_t) ((start + (std::uint64_t) i) % (std::uint64_t) capacity)] = shortTermLufs;
 
-    if (integratedScratch.size() < count)
-        integratedScratch.resize (capacity);
+        shared.loudnessHistoryRing.endWrite();
+    }
 
-    size_t valid = 0;
-    for (size_t i = 0; i < count; ++i)
+    auto& frame = shared.meters.getWriteFrame();
+    frame.lissajousCount = lissaCount;
+    if (lissaCount > 0)
+        std::copy (lissa.begin(), lissa.begin() + lissaCount, frame.lissajousPoints.begin());
+
+    frame.momentaryLufs = momentaryLufs;
+    frame.shortTermLufs = shortTermLufs;
+    frame.integratedLufs = loudnessEngine.getIntegratedLoudness();
+    frame.loudnessRange = loudnessEngine.getLoudnessRange();
+    frame.maxMomentary = loudnessEngine.getMaxMomentaryLoudness();
+    frame.maxShortTerm = loudnessEngine.getMaxShortTermLoudness();
+    frame.rmsFast = rmsFastValue;
+    frame.rmsSlow = rmsSlowValue;
+    frame.correlation = corr;
+    frame.stereoWidth = stereoWidth;
+    frame.leftRms = rmsBlockL;
+    frame.rightRms = rmsBlockR;
+    frame.midRms = midRmsBlock;
+    frame.sideRms = sideRmsBlock;
+    frame.balanceDb = balanceDb;
+    frame.vuNeedleL = vuEnergyL;
+    frame.vuNeedleR = vuEnergyR;
+    frame.clippedL = clippedL;
+    frame.clippedR = clippedR;
+    frame.truePeakL = numCh >= 1 ? maxChannelTruePeak[(size_t) channelLayout.displayLeft] : 0.0f;
+    frame.truePeakR = numCh >= 2 ? maxChannelTruePeak[(size_t) channelLayout.displayRight] : 0.0f;
+    frame.numChannels = numChannels;
+    frame.channelPeak = channelPeakHold;
+    frame.channelTruePeak = maxChannelTruePeak;
+    frame.channelRms = channelRms;
+    frame.channelClipped = channelClipped;
+    frame.numPairs = channelLayout.numPairs;
+    frame.pairCorrelation = pairCorrelation;
+    frame.numOctaveBands = octaveBands.getNumBands();
+    for (int band = 0; band < frame.numOctaveBands; ++band)
     {
-        const float energy = integratedBlockEnergies[(start + i) % capacity];
-        const float loudness = energyToLoudness (energy);
-        if (loudness > -70.0f)
-            integratedScratch[valid++] = energy;
+        frame.octaveBandLevels[(size_t) band] = octaveBands.getBandLevel (band);
+        frame.octaveBandFrequencies[(size_t) band] = octaveBands.getCentreFrequency (band);
     }
+    frame.transport = transportForBlock;
+    frame.silent = silentSamples >= silenceHoldSamples;
+    frame.droppedSamples = droppedAnalysisSamples.load (std::memory_order_relaxed);
+    shared.meters.publish();
+}
 
-    if (valid == 0)
+void MiniMetersCloneAudioProcessor::analyseSpectrum (const float* left, const float* right, const float* mono, int n, bool displayActive)
+{
+    auto& spectrumAverages = spectrumEngine->averages;
+    const int spectrumBins = (int) spectrumAverages[StereoStftAnalyzer::mid].size();
+    bool spectrumFrameUpdated = false;
+    const int spectrogramColumns = shared.spectrogramHistory.getNumFrames();
+    auto writeSpectrogramColumn = [&] (const float* magnitudes)
     {
-        integratedLoudness = -100.0f;
-        updateLoudnessRange();
-        return;
-    }
+        if (spectrogramColumns <= 0)
+            return;
 
-    double sum = 0.0;
-    for (size_t i = 0; i < valid; ++i)
-        sum += integratedScratch[i];
+        const int column = (int) (shared.spectrogramRing.beginWrite (1) % (std::uint64_t) spectrogramColumns);
+        shared.spectrogramHistory.writeFrame (column, magnitudes, spectrumBins);
 
-    const double averageEnergy = sum / (double) valid;
-    const float averageLoudness = energyToLoudness ((float) averageEnergy);
-    const float relativeGate = averageLoudness - 10.0f;
+        shared.spectrogramRing.endWrite();
+    };
 
-    double gatedSum = 0.0;
-    size_t gatedCount = 0;
-    for (size_t i = 0; i < valid; ++i)
+    // The long-term average covers the whole session, so frames feed it even with no display attached.
+    auto handleSpectrumFrame = [&] (const float* const* traces, int numTraces)
     {
-        const float loudness = energyToLoudness (integratedScratch[i]);
-        if (loudness >= relativeGate)
-        {
-            gatedSum += integratedScratch[i];
-            ++gatedCount;
-        }
-    }
+        spectrumEngine->longTerm.addFrame (traces[StereoStftAnalyzer::mid]);
 
-    if (gatedCount == 0)
-        integratedLoudness = averageLoudness;
-    else
-        integratedLoudness = energyToLoudness ((float) (gatedSum / (double) gatedCount));
+        if (! displayActive)
+            return;
 
-    updateLoudnessRange();
-}
+        const float smoothing = 0.6f;
+        for (int trace = 0; trace < numTraces; ++trace)
+        {
+            auto& averages = spectrumAverages[(size_t) trace];
+            const float* magnitudes = traces[trace];
+            for (int bin = 0; bin < (int) averages.size(); ++bin)
+                averages[(size_t) bin] = smoothing * averages[(size_t) bin] + (1.0f - smoothing) * magnitudes[bin];
+        }
 
-void MiniMetersCloneAudioProcessor::pushShortTermHistoryValue (float value)
-{
-    if (shortTermHistoryBuffer.empty())
-        return;
+        if (! spectrumEngine->useReassignment)
+            writeSpectrogramColumn (traces[StereoStftAnalyzer::mid]);
 
-    value = juce::jlimit (-100.0f, 10.0f, value);
-    const size_t capacity = shortTermHistoryBuffer.size();
-    shortTermHistoryBuffer[shortTermHistoryWriteIndex] = value;
-    shortTermHistoryWriteIndex = (shortTermHistoryWriteIndex + 1) % capacity;
-    shortTermHistoryFilled = juce::jmin (capacity, shortTermHistoryFilled + 1);
-}
+        spectrumFrameUpdated = true;
+    };
 
-void MiniMetersCloneAudioProcessor::updateLoudnessRange()
-{
-    if (shortTermHistoryFilled < 2 || shortTermHistoryBuffer.empty())
+    if (spectrumEngine->useMultiResolution)
     {
-        loudnessRangeValue = 0.0f;
-        return;
+        spectrumEngine->multiResolution.process (mono, n, [&] (const float* magnitudes)
+        {
+            handleSpectrumFrame (&magnitudes, 1);
+        });
     }
-
-    const size_t capacity = shortTermHistoryBuffer.size();
-    const size_t count = shortTermHistoryFilled;
-    const size_t start = (shortTermHistoryWriteIndex + capacity - count) % capacity;
-
-    if (shortTermScratch.size() < count)
-        shortTermScratch.resize (capacity);
-
-    for (size_t i = 0; i < count; ++i)
-        shortTermScratch[i] = shortTermHistoryBuffer[(start + i) % capacity];
-
-    const float gatingThreshold = integratedLoudness - 20.0f;
-    auto first = shortTermScratch.begin();
-    auto last = first + static_cast<std::vector<float>::difference_type> (count);
-    auto newEnd = std::remove_if (first, last, [gatingThreshold] (float value)
+    else
     {
-        return value < gatingThreshold;
-    });
+        spectrumEngine->stft.process (left != nullptr ? left : mono, right != nullptr ? right : mono, n, [&] (const float* const* traces)
+        {
+            handleSpectrumFrame (traces, StereoStftAnalyzer::numTraces);
+        });
 
-    const size_t valid = (size_t) std::distance (first, newEnd);
-    if (valid < 2)
-    {
-        loudnessRangeValue = 0.0f;
-        return;
+        if (displayActive && spectrumEngine->useReassignment)
+            spectrumEngine->reassigned.process (mono, n, writeSpectrogramColumn);
     }
 
-    std::sort (shortTermScratch.begin(), shortTermScratch.begin() + static_cast<std::vector<float>::difference_type> (valid));
-
-    auto percentile = [this, valid] (float p)
+    if (spectrumFrameUpdated)
     {
-        const float index = (valid - 1) * p;
-        const size_t lower = (size_t) std::floor (index);
-        const size_t upper = juce::jmin (valid - 1, lower + 1);
-        const float fraction = index - (float) lower;
-        const float lowVal = shortTermScratch[lower];
-        const float highVal = shortTermScratch[upper];
-        return lowVal + (highVal - lowVal) * fraction;
-    };
+        auto& spectrumFrame = shared.spectrum.getWriteFrame();
+        for (size_t trace = 0; trace < spectrumFrame.size(); ++trace)
+            if (spectrumFrame[trace].size() == spectrumAverages[trace].size())
+                std::copy (spectrumAverages[trace].begin(), spectrumAverages[trace].end(), spectrumFrame[trace].begin());
+
+        shared.spectrum.publish();
+
+        const auto& longTerm = spectrumEngine->longTerm;
+        auto& longTermFrame = shared.longTermSpectrum.getWriteFrame();
+        if (longTermFrame.meanPower.size() == (size_t) longTerm.getNumBins())
+            longTerm.getPowerStatistics (longTermFrame.meanPower.data(), longTermFrame.powerVariance.data());
+        longTermFrame.numFrames = longTerm.getNumFrames();
 
-    const float low = percentile (0.10f);
-    const float high = percentile (0.95f);
-    loudnessRangeValue = juce::jmax (0.0f, high - low);
+        shared.longTermSpectrum.publish();
+    }
 }
 
 void MiniMetersCloneAudioProcessor::getStateInformation (juce::MemoryBlock& destData)
@@ -823,6 +778,20 @@ void MiniMetersCloneAudioProcessor::getStateInformation (juce::MemoryBlock& dest
     stereoTree.setProperty ("trailSeconds", stereoState.trailSeconds, nullptr);
     state.addChild (stereoTree, -1, nullptr);
 
+    const auto analysisSettings = getSpectrumAnalysisSettings();
+    juce::ValueTree spectrumTree ("SPECTRUM");
+    spectrumTree.setProperty ("fftOrder", analysisSettings.fftOrder, nullptr);
+    spectrumTree.setProperty ("window", analysisSettings.window, nullptr);
+    spectrumTree.setProperty ("overlap", analysisSettings.overlap, nullptr);
+    spectrumTree.setProperty ("multiResolution", analysisSettings.multiResolution, nullptr);
+    spectrumTree.setProperty ("spectrogramFormat", analysisSettings.spectrogramFormat, nullptr);
+    spectrumTree.setProperty ("reassignedSpectrogram", analysisSettings.reassignedSpectrogram, nullptr);
+    state.addChild (spectrumTree, -1, nullptr);
+
+    juce::ValueTree displayTree ("DISPLAY");
+    displayTree.setProperty ("refreshRate", editorRefreshRate, nullptr);
+    state.addChild (displayTree, -1, nullptr);
+
     juce::MemoryOutputStream mos (destData, false);
     state.writeToStream (mos);
 }
@@ -866,6 +835,21 @@ void MiniMetersCloneAudioProcessor::setStateInformation (const void* data, int s
             newState.persistence = (newState.displayMode == 3);
             setStereoMeterState (newState);
         }
+
+        if (auto spectrumTree = state.getChildWithName ("SPECTRUM"); spectrumTree.isValid())
+        {
+            auto newSettings = getSpectrumAnalysisSettings();
+            newSettings.fftOrder = (int) spectrumTree.getProperty ("fftOrder", newSettings.fftOrder);
+            newSettings.window = (int) spectrumTree.getProperty ("window", newSettings.window);
+            newSettings.overlap = (int) spectrumTree.getProperty ("overlap", newSettings.overlap);
+            newSettings.multiResolution = (bool) spectrumTree.getProperty ("multiResolution", newSettings.multiResolution);
+            newSettings.spectrogramFormat = (int) spectrumTree.getProperty ("spectrogramFormat", newSettings.spectrogramFormat);
+            newSettings.reassignedSpectrogram = (bool) spectrumTree.getProperty ("reassignedSpectrogram", newSettings.reassignedSpectrogram);
+            setSpectrumAnalysisSettings (newSettings);
+        }
+
+        if (auto displayTree = state.getChildWithName ("DISPLAY"); displayTree.isValid())
+            setEditorRefreshRate ((int) displayTree.getProperty ("refreshRate", editorRefreshRate));
     }
 }
 
@@ -894,204 +878,342 @@ juce::AudioProcessor* JUCE_CALLTYPE createPluginFilter()
 
 void MiniMetersCloneAudioProcessor::initialiseSharedState()
 {
-    const juce::SpinLock::ScopedLockType sl (shared.lock);
-    shared.audioHistory.setSize (2, 1, false, false, true);
+    const juce::SpinLock::ScopedLockType sl (shared.layoutLock);
+    shared.audioHistory.setSize (1, 1, false, false, true);
     shared.audioHistory.clear();
-    shared.writePosition = 0;
-    shared.hasWrapped = false;
+    shared.audioHistoryRing.reset();
     shared.waveformSamplesPerBucket = 1;
-    for (int ch = 0; ch < 2; ++ch)
+    shared.waveform.assign ((size_t) kWaveformDisplayChannels, {});
+    for (auto& channel : shared.waveform)
     {
-        shared.waveformMin[ch].assign ((size_t) kWaveformResolution, 0.0f);
-        shared.waveformMax[ch].assign ((size_t) kWaveformResolution, 0.0f);
-        shared.waveformCurrentMin[ch] = 1.0f;
-        shared.waveformCurrentMax[ch] = -1.0f;
+        channel.minimum.assign ((size_t) kWaveformResolution, 0.0f);
+        channel.maximum.assign ((size_t) kWaveformResolution, 0.0f);
+        for (auto& band : channel.bandEnergy)
+            band.assign ((size_t) kWaveformResolution, 0.0f);
     }
-    shared.waveformWriteIndex = 0;
-    shared.waveformFilled = 0;
-    shared.waveformSampleCounter = 0;
+    shared.waveformRing.reset();
     shared.oscilloscopeBuffer.assign ((size_t) kOscilloscopeBufferSize, 0.0f);
-    shared.oscilloscopeWriteIndex = 0;
-    shared.oscilloscopeFilled = 0;
-    shared.spectrum.clear();
-    shared.spectrumAverages.clear();
-    shared.spectrogramHistory.setSize (1, 1);
+    shared.oscilloscopeRing.reset();
+    shared.spectrogramHistory.setSize (1, 1, SpectrogramFrames::Format::decibels8);
     shared.spectrogramHistory.clear();
-    shared.spectrogramWritePosition = 0;
-    shared.spectrogramWrapped = false;
-    shared.lissajousCount = 0;
-    shared.momentaryLufs = shared.shortTermLufs = -100.0f;
-    shared.integratedLufs = -100.0f;
-    shared.loudnessRange = 0.0f;
-    shared.maxMomentary = -100.0f;
-    shared.maxShortTerm = -100.0f;
-    shared.rmsFast = shared.rmsSlow = 0.0f;
-    shared.correlation = shared.stereoWidth = 0.0f;
-    shared.leftRms = shared.rightRms = 0.0f;
-    shared.midRms = shared.sideRms = 0.0f;
-    shared.balanceDb = 0.0f;
-    shared.vuNeedleL = shared.vuNeedleR = 0.0f;
-    shared.clippedL = shared.clippedR = false;
+    shared.spectrogramRing.reset();
+    ++shared.spectrogramGeneration;
+    shared.spectrogramSecondsPerColumn = 0.0;
+    shared.spectrumFrequencies.clear();
     shared.loudnessHistory.clear();
-    shared.loudnessHistoryWrite = 0;
-    shared.loudnessHistoryFilled = 0;
+    shared.loudnessHistoryRing.reset();
     shared.loudnessHistoryInterval = kLoudnessHistoryIntervalSeconds;
-    shared.transport = {};
+    shared.spectrum.initialise ([] (SpectrumTraces& frame)
+    {
+        for (auto& trace : frame)
+            trace.clear();
+    });
+    shared.longTermSpectrum.initialise ([] (LongTermSpectrumFrame& frame) { frame = {}; });
+    shared.meters.initialise ([] (MeterFrame& frame) { frame = {}; });
     lastTransportInfo = {};
 }
 
-void MiniMetersCloneAudioProcessor::fillSnapshot (SharedDataSnapshot& snapshot, bool includeAudioHistory) const
+struct RingReadResult
+{
+    std::uint64_t begin = 0;
+    int count = 0;
+    int torn = 0;
+};
+
+template <typename CopyFunction>
+static RingReadResult readPublishedRing (const RingPublication& ring, int capacity, CopyFunction&& copyItems,
+                                         std::uint64_t firstWanted = 0)
+{
+    RingReadResult result;
+    if (capacity <= 0)
+        return result;
+
+    auto range = ring.getReadableRange (capacity);
+    range.begin = juce::jlimit (range.begin, range.end, firstWanted);
+    result.begin = range.begin;
+    result.count = range.size();
+
+    if (result.count > 0)
+        copyItems (range.begin, result.count);
+
+    const auto firstIntact = ring.getFirstIntactIndex (capacity);
+    if (firstIntact > range.begin)
+        result.torn = (int) juce::jmin ((std::uint64_t) result.count, firstIntact - range.begin);
+
+    return result;
+}
+
+static void copyRingItems (const float* ring, int capacity, std::uint64_t first, int count, float* dest) noexcept
+{
+    int srcIndex = (int) (first % (std::uint64_t) capacity);
+    int copied = 0;
+    while (copied < count)
+    {
+        const int chunk = juce::jmin (count - copied, capacity - srcIndex);
+        std::copy (ring + srcIndex, ring + srcIndex + chunk, dest + copied);
+        copied += chunk;
+        srcIndex = 0;
+    }
+}
+
+static void dropOldestItems (std::vector<float>& items, int count) noexcept
+{
+    if (count > 0)
+        items.erase (items.begin(), items.begin() + juce::jmin ((int) items.size(), count));
+}
+
+static void dropOldestItems (juce::AudioBuffer<float>& items, int count)
 {
-    const juce::SpinLock::ScopedTryLockType sl (shared.lock);
+    const int remaining = items.getNumSamples() - count;
+    if (count <= 0 || remaining < 0)
+        return;
+
+    for (int ch = 0; ch < items.getNumChannels(); ++ch)
+    {
+        auto* data = items.getWritePointer (ch);
+        std::copy (data + count, data + count + remaining, data);
+    }
+
+    items.setSize (items.getNumChannels(), remaining, true, false, true);
+}
+
+static int readAudioHistory (const juce::AudioBuffer<float>& history, const RingPublication& ring, juce::AudioBuffer<float>& dest)
+{
+    const int capacity = history.getNumSamples();
+    const int channels = history.getNumChannels();
+
+    auto result = readPublishedRing (ring, capacity, [&] (std::uint64_t first, int count)
+    {
+        dest.setSize (channels, count, false, false, true);
+        for (int ch = 0; ch < channels; ++ch)
+            copyRingItems (history.getReadPointer (ch), capacity, first, count, dest.getWritePointer (ch));
+    });
+
+    if (result.count <= 0)
+        dest.setSize (channels, 0);
+
+    dropOldestItems (dest, result.torn);
+    return result.count - result.torn;
+}
+
+void MiniMetersCloneAudioProcessor::fillSnapshot (SharedDataSnapshot& snapshot, std::uint32_t sections)
+{
+    const juce::SpinLock::ScopedTryLockType sl (shared.layoutLock);
     if (! sl.isLocked())
         return;
 
-    snapshot.writePosition = shared.writePosition;
-    snapshot.bufferWrapped = shared.hasWrapped;
+    auto wants = [sections] (SharedDataSnapshot::Section section) { return (sections & section) != 0; };
 
-    if (includeAudioHistory && shared.audioHistory.getNumSamples() > 0)
+    if (wants (SharedDataSnapshot::audioHistoryData) && shared.audioHistory.getNumSamples() > 0)
     {
-        snapshot.audioHistory.makeCopyOf (shared.audioHistory);
+        snapshot.writePosition = readAudioHistory (shared.audioHistory, shared.audioHistoryRing, snapshot.audioHistory);
+        snapshot.bufferWrapped = false;
     }
-    else if (! includeAudioHistory)
+    else if (! wants (SharedDataSnapshot::audioHistoryData))
     {
         snapshot.audioHistory.setSize (0, 0);
     }
 
-    snapshot.waveformSamplesPerBucket = shared.waveformSamplesPerBucket;
-
-    const int bucketCapacity = (int) shared.waveformMin[0].size();
-    const int validWaveform = juce::jmin (shared.waveformFilled, bucketCapacity);
-    if (validWaveform > 0)
+    if (wants (SharedDataSnapshot::waveformData))
     {
-        snapshot.waveformLeftMins.resize ((size_t) validWaveform);
-        snapshot.waveformLeftMaxs.resize ((size_t) validWaveform);
-        snapshot.waveformRightMins.resize ((size_t) validWaveform);
-        snapshot.waveformRightMaxs.resize ((size_t) validWaveform);
-        snapshot.waveformLeftLowBand.resize ((size_t) validWaveform);
-        snapshot.waveformLeftMidBand.resize ((size_t) validWaveform);
-        snapshot.waveformLeftHighBand.resize ((size_t) validWaveform);
-        snapshot.waveformRightLowBand.resize ((size_t) validWaveform);
-        snapshot.waveformRightMidBand.resize ((size_t) validWaveform);
-        snapshot.waveformRightHighBand.resize ((size_t) validWaveform);
-
-        const int start = (shared.waveformWriteIndex - validWaveform + bucketCapacity) % bucketCapacity;
-        for (int i = 0; i < validWaveform; ++i)
+        snapshot.waveformSequence = shared.waveformRing.getSequence();
+        snapshot.waveformSamplesPerBucket = shared.waveformSamplesPerBucket;
+
+        std::vector<float>* waveformDest[] = { &snapshot.waveformLeftMins, &snapshot.waveformLeftMaxs,
+                                               &snapshot.waveformRightMins, &snapshot.waveformRightMaxs,
+                                               &snapshot.waveformLeftLowBand, &snapshot.waveformLeftMidBand, &snapshot.waveformLeftHighBand,
+                                               &snapshot.waveformRightLowBand, &snapshot.waveformRightMidBand, &snapshot.waveformRightHighBand };
+        const auto& leftWaveform = shared.waveform[0];
+        const auto& rightWaveform = shared.waveform[1];
+        const std::vector<float>* waveformSource[] = { &leftWaveform.minimum, &leftWaveform.maximum,
+                                                       &rightWaveform.minimum, &rightWaveform.maximum,
+                                                       &leftWaveform.bandEnergy[0], &leftWaveform.bandEnergy[1], &leftWaveform.bandEnergy[2],
+                                                       &rightWaveform.bandEnergy[0], &rightWaveform.bandEnergy[1], &rightWaveform.bandEnergy[2] };
+
+        const int bucketCapacity = (int) leftWaveform.minimum.size();
+        const auto waveformRead = readPublishedRing (shared.waveformRing, bucketCapacity, [&] (std::uint64_t first, int count)
+        {
+            for (size_t i = 0; i < std::size (waveformDest); ++i)
+            {
+                waveformDest[i]->resize ((size_t) count);
+                copyRingItems (waveformSource[i]->data(), bucketCapacity, first, count, waveformDest[i]->data());
+            }
+        });
+
+        for (auto* dest : waveformDest)
         {
-            const int idx = (start + i) % bucketCapacity;
-            snapshot.waveformLeftMins[(size_t) i] = shared.waveformMin[0][(size_t) idx];
-            snapshot.waveformLeftMaxs[(size_t) i] = shared.waveformMax[0][(size_t) idx];
-            snapshot.waveformRightMins[(size_t) i] = shared.waveformMin[1][(size_t) idx];
-            snapshot.waveformRightMaxs[(size_t) i] = shared.waveformMax[1][(size_t) idx];
-            snapshot.waveformLeftLowBand[(size_t) i] = shared.waveformBandEnergy[0][0][(size_t) idx];
-            snapshot.waveformLeftMidBand[(size_t) i] = shared.waveformBandEnergy[0][1][(size_t) idx];
-            snapshot.waveformLeftHighBand[(size_t) i] = shared.waveformBandEnergy[0][2][(size_t) idx];
-            snapshot.waveformRightLowBand[(size_t) i] = shared.waveformBandEnergy[1][0][(size_t) idx];
-            snapshot.waveformRightMidBand[(size_t) i] = shared.waveformBandEnergy[1][1][(size_t) idx];
-            snapshot.waveformRightHighBand[(size_t) i] = shared.waveformBandEnergy[1][2][(size_t) idx];
+            if (waveformRead.count <= 0)
+                dest->clear();
+            else
+                dropOldestItems (*dest, waveformRead.torn);
         }
     }
-    else
-    {
-        snapshot.waveformLeftMins.clear();
-        snapshot.waveformLeftMaxs.clear();
-        snapshot.waveformRightMins.clear();
-        snapshot.waveformRightMaxs.clear();
-        snapshot.waveformLeftLowBand.clear();
-        snapshot.waveformLeftMidBand.clear();
-        snapshot.waveformLeftHighBand.clear();
-        snapshot.waveformRightLowBand.clear();
-        snapshot.waveformRightMidBand.clear();
-        snapshot.waveformRightHighBand.clear();
-    }
 
-    const int oscValid = juce::jmin ((int) shared.oscilloscopeBuffer.size(), shared.oscilloscopeFilled);
-    if (oscValid > 0)
+    if (wants (SharedDataSnapshot::oscilloscopeData))
     {
-        snapshot.oscilloscope.resize ((size_t) oscValid);
+        snapshot.oscilloscopeSequence = shared.oscilloscopeRing.getSequence();
         const int oscSize = (int) shared.oscilloscopeBuffer.size();
-        const int start = (shared.oscilloscopeWriteIndex - oscValid + oscSize) % oscSize;
-        for (int i = 0; i < oscValid; ++i)
+        const auto oscRead = readPublishedRing (shared.oscilloscopeRing, oscSize, [&] (std::uint64_t first, int count)
         {
-            const int idx = (start + i) % oscSize;
-            snapshot.oscilloscope[(size_t) i] = shared.oscilloscopeBuffer[(size_t) idx];
-        }
+            snapshot.oscilloscope.resize ((size_t) count);
+            copyRingItems (shared.oscilloscopeBuffer.data(), oscSize, first, count, snapshot.oscilloscope.data());
+        });
+
+        if (oscRead.count <= 0)
+            snapshot.oscilloscope.clear();
+        else
+            dropOldestItems (snapshot.oscilloscope, oscRead.torn);
     }
-    else
+
+    if (wants (SharedDataSnapshot::spectrumData))
     {
-        snapshot.oscilloscope.clear();
+        snapshot.spectrumSequence = shared.spectrum.getSequence();
+        shared.spectrum.fetch();
+        const auto& spectrumTraces = shared.spectrum.getReadFrame();
+        snapshot.spectrum = spectrumTraces[StereoStftAnalyzer::mid];
+        snapshot.spectrumLeft = spectrumTraces[StereoStftAnalyzer::left];
+        snapshot.spectrumRight = spectrumTraces[StereoStftAnalyzer::right];
+        snapshot.spectrumSide = spectrumTraces[StereoStftAnalyzer::side];
     }
 
-    snapshot.spectrum = shared.spectrumAverages;
+    if (wants (SharedDataSnapshot::longTermSpectrumData))
+    {
+        snapshot.longTermSpectrumSequence = shared.longTermSpectrum.getSequence();
+        shared.longTermSpectrum.fetch();
+        const auto& longTermFrame = shared.longTermSpectrum.getReadFrame();
+        snapshot.longTermSpectrumPower = longTermFrame.meanPower;
+        snapshot.longTermSpectrumVariance = longTermFrame.powerVariance;
+        snapshot.longTermSpectrumFrames = longTermFrame.numFrames;
+    }
 
-    if (shared.spectrogramHistory.getNumSamples() > 0)
+    if (wants (SharedDataSnapshot::spectrogramData))
     {
-        snapshot.spectrogram = shared.spectrogramHistory;
-        snapshot.spectrogramWritePosition = shared.spectrogramWritePosition;
-        snapshot.spectrogramWrapped = shared.spectrogramWrapped;
+        // Only the columns written since the cursor are copied, so a UI frame costs the ~3 new columns, not the history.
+        const int spectrogramColumns = shared.spectrogramHistory.getNumFrames();
+        const auto available = shared.spectrogramRing.getReadableRange (spectrogramColumns);
+        snapshot.spectrogramRestarted = snapshot.spectrogramGeneration != shared.spectrogramGeneration
+                                     || snapshot.spectrogramCursor < available.begin
+                                     || snapshot.spectrogramCursor > available.end;
+
+        const auto spectrogramRead = readPublishedRing (shared.spectrogramRing, spectrogramColumns, [&] (std::uint64_t first, int count)
+        {
+            snapshot.spectrogram.copyFromRing (shared.spectrogramHistory, first, count);
+        }, snapshot.spectrogramRestarted ? 0 : snapshot.spectrogramCursor);
+
+        if (spectrogramRead.count <= 0)
+            snapshot.spectrogram.setSize (0, shared.spectrogramHistory.getFrameSize(), shared.spectrogramHistory.getFormat());
+        else
+            snapshot.spectrogram.dropOldestFrames (spectrogramRead.torn);
+
+        if (spectrogramRead.torn > 0)
+            snapshot.spectrogramRestarted = true;
+
+        snapshot.spectrogramFirstFrame = spectrogramRead.begin + (std::uint64_t) spectrogramRead.torn;
+        snapshot.spectrogramCursor = spectrogramRead.begin + (std::uint64_t) spectrogramRead.count;
+        snapshot.spectrogramGeneration = shared.spectrogramGeneration;
+        snapshot.spectrogramCapacity = spectrogramColumns;
+        snapshot.spectrogramSecondsPerColumn = shared.spectrogramSecondsPerColumn;
     }
 
-    snapshot.lissajousCount = shared.lissajousCount;
-    for (int i = 0; i < shared.lissajousCount; ++i)
+    if (wants (SharedDataSnapshot::spectrumData) || wants (SharedDataSnapshot::longTermSpectrumData)
+        || wants (SharedDataSnapshot::spectrogramData))
+        snapshot.spectrumFrequencies = shared.spectrumFrequencies;
+
+    snapshot.meterSequence = shared.meters.getSequence();
+    shared.meters.fetch();
+    const auto& frame = shared.meters.getReadFrame();
+    snapshot.signalSilent = frame.silent;
+
+    if (wants (SharedDataSnapshot::lissajousData))
     {
-        const auto index = static_cast<size_t> (i);
-        snapshot.lissajous[index] = shared.lissajousPoints[index];
+        snapshot.lissajousCount = frame.lissajousCount;
+        std::copy (frame.lissajousPoints.begin(), frame.lissajousPoints.begin() + frame.lissajousCount, snapshot.lissajous.begin());
     }
 
-    snapshot.momentaryLufs = shared.momentaryLufs;
-    snapshot.shortTermLufs = shared.shortTermLufs;
-    snapshot.integratedLufs = shared.integratedLufs;
-    snapshot.loudnessRange = shared.loudnessRange;
-    snapshot.maxMomentaryLufs = shared.maxMomentary;
-    snapshot.maxShortTermLufs = shared.maxShortTerm;
-    snapshot.rmsFast = shared.rmsFast;
-    snapshot.rmsSlow = shared.rmsSlow;
-    snapshot.correlation = shared.correlation;
-    snapshot.stereoWidth = shared.stereoWidth;
-    snapshot.leftRms = shared.leftRms;
-    snapshot.rightRms = shared.rightRms;
-    snapshot.midRms = shared.midRms;
-    snapshot.sideRms = shared.sideRms;
-    snapshot.balanceDb = shared.balanceDb;
-    snapshot.vuNeedleL = shared.vuNeedleL;
-    snapshot.vuNeedleR = shared.vuNeedleR;
-    snapshot.clipLeft = shared.clippedL;
-    snapshot.clipRight = shared.clippedR;
+    snapshot.momentaryLufs = frame.momentaryLufs;
+    snapshot.shortTermLufs = frame.shortTermLufs;
+    snapshot.integratedLufs = frame.integratedLufs;
+    snapshot.loudnessRange = frame.loudnessRange;
+    snapshot.maxMomentaryLufs = frame.maxMomentary;
+    snapshot.maxShortTermLufs = frame.maxShortTerm;
+    snapshot.rmsFast = frame.rmsFast;
+    snapshot.rmsSlow = frame.rmsSlow;
+    snapshot.correlation = frame.correlation;
+    snapshot.stereoWidth = frame.stereoWidth;
+    snapshot.leftRms = frame.leftRms;
+    snapshot.rightRms = frame.rightRms;
+    snapshot.midRms = frame.midRms;
+    snapshot.sideRms = frame.sideRms;
+    snapshot.balanceDb = frame.balanceDb;
+    snapshot.vuNeedleL = frame.vuNeedleL;
+    snapshot.vuNeedleR = frame.vuNeedleR;
+    snapshot.clipLeft = frame.clippedL;
+    snapshot.clipRight = frame.clippedR;
+    snapshot.truePeakLeft = frame.truePeakL;
+    snapshot.truePeakRight = frame.truePeakR;
+    snapshot.droppedAnalysisSamples = frame.droppedSamples;
     snapshot.peakLeft = peakL.load (std::memory_order_relaxed);
     snapshot.peakRight = peakR.load (std::memory_order_relaxed);
-    snapshot.sampleRate = getSampleRate();
-    snapshot.loudnessHistoryInterval = shared.loudnessHistoryInterval;
-    snapshot.transport = shared.transport;
 
-    const int loudnessValid = juce::jmin ((int) shared.loudnessHistory.size(), shared.loudnessHistoryFilled);
-    if (loudnessValid > 0)
+    if (wants (SharedDataSnapshot::channelData))
     {
-        snapshot.loudnessHistory.resize ((size_t) loudnessValid);
-        const int capacity = (int) shared.loudnessHistory.size();
-        const int start = (shared.loudnessHistoryWrite - loudnessValid + capacity) % capacity;
-        for (int i = 0; i < loudnessValid; ++i)
+        snapshot.channels.resize ((size_t) juce::jmin (frame.numChannels, shared.channelNames.size()));
+        for (size_t ch = 0; ch < snapshot.channels.size(); ++ch)
+        {
+            auto& reading = snapshot.channels[ch];
+            reading.name = shared.channelNames[(int) ch];
+            reading.peak = frame.channelPeak[ch];
+            reading.truePeak = frame.channelTruePeak[ch];
+            reading.rms = frame.channelRms[ch];
+            reading.clipped = frame.channelClipped[ch];
+        }
+
+        snapshot.channelPairs.resize ((size_t) juce::jmin (frame.numPairs, shared.pairNames.size()));
+        for (size_t p = 0; p < snapshot.channelPairs.size(); ++p)
         {
-            const int idx = (start + i) % capacity;
-            snapshot.loudnessHistory[(size_t) i] = shared.loudnessHistory[(size_t) idx];
+            snapshot.channelPairs[p].name = shared.pairNames[(int) p];
+            snapshot.channelPairs[p].correlation = frame.pairCorrelation[p];
         }
     }
-    else
+
+    snapshot.sampleRate = getSampleRate();
+    snapshot.loudnessHistoryInterval = shared.loudnessHistoryInterval;
+    snapshot.transport = frame.transport;
+
+    if (wants (SharedDataSnapshot::octaveBandData))
+    {
+        snapshot.octaveBandLevels.assign (frame.octaveBandLevels.begin(), frame.octaveBandLevels.begin() + frame.numOctaveBands);
+        snapshot.octaveBandFrequencies.assign (frame.octaveBandFrequencies.begin(), frame.octaveBandFrequencies.begin() + frame.numOctaveBands);
+    }
+
+    if (wants (SharedDataSnapshot::loudnessHistoryData))
     {
-        snapshot.loudnessHistory.clear();
+        snapshot.loudnessHistorySequence = shared.loudnessHistoryRing.getSequence();
+        const int loudnessCapacity = (int) shared.loudnessHistory.size();
+        const auto loudnessRead = readPublishedRing (shared.loudnessHistoryRing, loudnessCapacity, [&] (std::uint64_t first, int count)
+        {
+            snapshot.loudnessHistory.resize ((size_t) count);
+            copyRingItems (shared.loudnessHistory.data(), loudnessCapacity, first, count, snapshot.loudnessHistory.data());
+        });
+
+        if (loudnessRead.count <= 0)
+            snapshot.loudnessHistory.clear();
+        else
+            dropOldestItems (snapshot.loudnessHistory, loudnessRead.torn);
     }
 }
 
 void MiniMetersCloneAudioProcessor::requestAudioDump (juce::AudioBuffer<float>& dest, bool& hasWrapped) const
 {
-    const juce::SpinLock::ScopedTryLockType sl (shared.lock);
+    const juce::SpinLock::ScopedTryLockType sl (shared.layoutLock);
     if (! sl.isLocked())
         return;
 
-    hasWrapped = shared.hasWrapped;
-    dest.makeCopyOf (shared.audioHistory);
+    const int available = readAudioHistory (shared.audioHistory, shared.audioHistoryRing, dest);
+    hasWrapped = available >= shared.audioHistory.getNumSamples();
 }
 
-static int sanitiseHistorySeconds (int value, std::initializer_list<int> allowed)
+static int snapToAllowedValue (int value, std::initializer_list<int> allowed)
 {
     if (allowed.size() == 0)
         return value;
@@ -1115,7 +1237,7 @@ void MiniMetersCloneAudioProcessor::setLoudnessMeterState (const LoudnessMeterSt
 {
     LoudnessMeterState sanitised = newState;
     sanitised.targetLufs = juce::jlimit (-36.0f, -6.0f, sanitised.targetLufs);
-    sanitised.historySeconds = sanitiseHistorySeconds (sanitised.historySeconds, { 20, 60, 120 });
+    sanitised.historySeconds = snapToAllowedValue (sanitised.historySeconds, { 20, 60, 120 });
     loudnessState = sanitised;
 }
 
@@ -1125,7 +1247,7 @@ void MiniMetersCloneAudioProcessor::setStereoMeterState (const StereoMeterState&
     sanitised.viewMode = (sanitised.viewMode == 2) ? 2 : 1;
     sanitised.displayMode = juce::jlimit (1, 3, sanitised.displayMode);
     sanitised.scopeScale = juce::jlimit (0.5f, 2.0f, sanitised.scopeScale);
-    sanitised.historySeconds = sanitiseHistorySeconds (sanitised.historySeconds, { 3, 6, 12, 24 });
+    sanitised.historySeconds = snapToAllowedValue (sanitised.historySeconds, { 3, 6, 12, 24 });
     sanitised.freeze = newState.freeze;
     sanitised.trailSeconds = juce::jlimit (0.2f, 3.0f, sanitised.trailSeconds);
     sanitised.showDots = (sanitised.displayMode == 2);
@@ -1133,19 +1255,212 @@ void MiniMetersCloneAudioProcessor::setStereoMeterState (const StereoMeterState&
     stereoState = sanitised;
 }
 
+void MiniMetersCloneAudioProcessor::setEditorRefreshRate (int framesPerSecond) noexcept
+{
+    editorRefreshRate = snapToAllowedValue (framesPerSecond, { 30, 60, 120, 144 });
+}
+
 void MiniMetersCloneAudioProcessor::resetLoudnessStatistics() noexcept
 {
-    maxMomentaryLufs = -100.0f;
-    maxShortTermLufs = -100.0f;
     peakL.store (0.0f, std::memory_order_relaxed);
     peakR.store (0.0f, std::memory_order_relaxed);
+    loudnessResetRequested.store (true, std::memory_order_release);
+}
+
+void MiniMetersCloneAudioProcessor::resetLongTermSpectrum() noexcept
+{
+    longTermSpectrumResetRequested.store (true, std::memory_order_release);
+}
+
+void MiniMetersCloneAudioProcessor::addDisplaySubscriber() noexcept
+{
+    displaySubscribers.fetch_add (1, std::memory_order_release);
+}
+
+void MiniMetersCloneAudioProcessor::removeDisplaySubscriber() noexcept
+{
+    jassert (displaySubscribers.load() > 0);
+    displaySubscribers.fetch_sub (1, std::memory_order_release);
+}
+
+SpectrumAnalysisSettings MiniMetersCloneAudioProcessor::getSpectrumAnalysisSettings() const noexcept
+{
+    const juce::SpinLock::ScopedLockType sl (spectrumSettingsLock);
+    return spectrumSettings;
+}
+
+void MiniMetersCloneAudioProcessor::setSpectrumAnalysisSettings (const SpectrumAnalysisSettings& newSettings)
+{
+    SpectrumAnalysisSettings sanitised = newSettings;
+    sanitised.fftOrder = juce::jlimit (StftAnalyzer::minFftOrder, StftAnalyzer::maxFftOrder, sanitised.fftOrder);
+    sanitised.window = juce::jlimit ((int) StftAnalyzer::Window::hann, (int) StftAnalyzer::Window::kaiser, sanitised.window);
+    sanitised.overlap = snapToAllowedValue (sanitised.overlap, { (int) StftAnalyzer::Overlap::half,
+                                                                     (int) StftAnalyzer::Overlap::threeQuarters,
+                                                                     (int) StftAnalyzer::Overlap::sevenEighths });
+    sanitised.spectrogramFormat = juce::jlimit ((int) SpectrogramFrames::Format::decibels8,
+                                                (int) SpectrogramFrames::Format::decibels16, sanitised.spectrogramFormat);
+
+    {
+        const juce::SpinLock::ScopedLockType sl (spectrumSettingsLock);
+        if (sanitised == spectrumSettings)
+            return;
+
+        spectrumSettings = sanitised;
+    }
+
+    // Before prepareToPlay the builder is idle and the next prepare picks the settings up.
+    spectrumEngineBuilder.notify();
+}
+
+std::unique_ptr<MiniMetersCloneAudioProcessor::SpectrumEngine>
+MiniMetersCloneAudioProcessor::createSpectrumEngine (const SpectrumAnalysisSettings& settings, double sampleRate)
+{
+    auto engine = std::make_unique<SpectrumEngine>();
+    const auto overlap = static_cast<StftAnalyzer::Overlap> (settings.overlap);
+    const auto window = static_cast<StftAnalyzer::Window> (settings.window);
+    engine->useMultiResolution = settings.multiResolution;
+
+    int bins = 0, hopSamples = 1;
+    if (engine->useMultiResolution)
+    {
+        engine->multiResolution.prepare (sampleRate, settings.fftOrder, overlap, window, kMultiResolutionFinestHz);
+        engine->binFrequencies = engine->multiResolution.getBinFrequencies();
+        bins = engine->multiResolution.getNumBins();
+        hopSamples = engine->multiResolution.getHopSize();
+    }
+    else
+    {
+        engine->stft.prepare (settings.fftOrder, overlap, window);
+        bins = engine->stft.getNumBins();
+        hopSamples = engine->stft.getHopSize();
+    }
+
+    // Reassignment needs uniform FFT bins, so the multi-resolution spectrum keeps plain columns.
+    engine->useReassignment = settings.reassignedSpectrogram && ! engine->useMultiResolution;
+    if (engine->useReassignment)
+        engine->reassigned.prepare (settings.fftOrder, overlap, window);
+
+    // The multi-resolution engine only analyses the downmix, so it has a mid trace alone.
+    const int numTraces = engine->useMultiResolution ? 1 : StereoStftAnalyzer::numTraces;
+    for (int trace = 0; trace < numTraces; ++trace)
+    {
+        engine->averages[(size_t) trace].assign ((size_t) bins, 0.0f);
+        for (auto& frame : engine->spectrumFrames)
+            frame[(size_t) trace].assign ((size_t) bins, 0.0f);
+    }
+
+    engine->longTerm.prepare (bins);
+    for (auto& frame : engine->longTermFrames)
+    {
+        frame.meanPower.assign ((size_t) bins, 0.0f);
+        frame.powerVariance.assign ((size_t) bins, 0.0f);
+        frame.numFrames = 0;
+    }
+
+    const double maxSpectrogramSeconds = 3.0;
+    const int historyWidth = juce::jmax (1, (int) std::ceil (maxSpectrogramSeconds * sampleRate / (double) hopSamples));
+    engine->spectrogramHistory.setSize (historyWidth, bins, static_cast<SpectrogramFrames::Format> (settings.spectrogramFormat));
+    engine->spectrogramHistory.clear();
+    engine->secondsPerColumn = sampleRate > 0.0 ? (double) hopSamples / sampleRate : 0.0;
+    return engine;
+}
+
+void MiniMetersCloneAudioProcessor::SpectrumEngineBuilder::run()
+{
+    while (! threadShouldExit())
+    {
+        wait (-1);
+
+        if (! threadShouldExit())
+            owner.buildRequestedSpectrumEngine();
+    }
+}
+
+void MiniMetersCloneAudioProcessor::buildRequestedSpectrumEngine()
+{
+    delete retiredSpectrumEngine.exchange (nullptr, std::memory_order_acquire);
+
+    auto engine = createSpectrumEngine (getSpectrumAnalysisSettings(), (double) sampleRate);
+    delete pendingSpectrumEngine.exchange (engine.release(), std::memory_order_acq_rel);
+}
+
+bool MiniMetersCloneAudioProcessor::installSpectrumEngine (std::unique_ptr<SpectrumEngine>& engine, bool waitForLock)
+{
+    if (waitForLock)
+        shared.layoutLock.enter();
+    else if (! shared.layoutLock.tryEnter())
+        return false;
+
+    std::swap (shared.spectrogramHistory, engine->spectrogramHistory);
+    shared.spectrogramRing.reset();
+    ++shared.spectrogramGeneration;
+    shared.spectrogramSecondsPerColumn = engine->secondsPerColumn;
+    shared.spectrumFrequencies.swap (engine->binFrequencies);
+
+    size_t frameIndex = 0;
+    shared.spectrum.initialise ([&] (SpectrumTraces& frame) { frame.swap (engine->spectrumFrames[frameIndex++]); });
+
+    frameIndex = 0;
+    shared.longTermSpectrum.initialise ([&] (LongTermSpectrumFrame& frame) { std::swap (frame, engine->longTermFrames[frameIndex++]); });
+
+    shared.layoutLock.exit();
+
+    // engine now carries the previous buffers, which the builder thread frees on its next build.
+    std::swap (spectrumEngine, engine);
+    delete retiredSpectrumEngine.exchange (engine.release(), std::memory_order_acq_rel);
+    return true;
+}
+
+void MiniMetersCloneAudioProcessor::installPendingSpectrumEngine()
+{
+    // A newer build waits in pendingSpectrumEngine until the staged one is in, so the builder still frees it.
+    if (stagedSpectrumEngine == nullptr)
+        stagedSpectrumEngine.reset (pendingSpectrumEngine.exchange (nullptr, std::memory_order_acq_rel));
+
+    // The UI may be copying a snapshot; rather than spin behind it, retry on the next block.
+    if (stagedSpectrumEngine != nullptr)
+        installSpectrumEngine (stagedSpectrumEngine, false);
+}
+
+void MiniMetersCloneAudioProcessor::discardQueuedSpectrumEngines()
+{
+    delete pendingSpectrumEngine.exchange (nullptr);
+    delete retiredSpectrumEngine.exchange (nullptr);
+    stagedSpectrumEngine.reset();
+}
+
+void MiniMetersCloneAudioProcessor::applyPendingLoudnessReset() noexcept
+{
+    if (! loudnessResetRequested.exchange (false, std::memory_order_acquire))
+        return;
+
+    loudnessEngine.resetMaxima();
+    channelPeakHold.fill (0.0f);
+    maxChannelTruePeak.fill (0.0f);
+    shared.loudnessHistoryRing.discard();
+}
+
+void MiniMetersCloneAudioProcessor::primeDisplayAnalysis()
+{
+    // The display stages skipped everything since the last subscriber left, so restart them from
+    // silence rather than let filters and averages carry state across the gap.
+    waveformBands.reset();
+    octaveBands.reset();
+    waveformSampleCounter = 0;
+    for (int ch = 0; ch < 2; ++ch)
+    {
+        waveformCurrentMin[ch] = 1.0f;
+        waveformCurrentMax[ch] = -1.0f;
+        waveformBandAccum[(size_t) ch].fill (0.0f);
+    }
+
+    // The STFTs keep running for the long-term average, so only the display-side state restarts.
+    spectrumEngine->reassigned.reset();
+    for (auto& trace : spectrumEngine->averages)
+        std::fill (trace.begin(), trace.end(), 0.0f);
 
-    const juce::SpinLock::ScopedLockType sl (shared.lock);
-    shared.maxMomentary = -100.0f;
-    shared.maxShortTerm = -100.0f;
-    shared.clippedL = false;
-    shared.clippedR = false;
-    shared.loudnessHistoryWrite = 0;
-    shared.loudnessHistoryFilled = 0;
-    std::fill (shared.loudnessHistory.begin(), shared.loudnessHistory.end(), -100.0f);
+    // Discarding moves each ring's origin past the stale items, which readers see as a restart; no lock needed.
+    shared.waveformRing.discard();
+    shared.oscilloscopeRing.discard();
+    shared.spectrogramRing.discard();
 }
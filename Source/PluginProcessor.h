@@ -4,11 +4,22 @@
 #include <array>
 #include <vector>
 #include <memory>
+#include "LockFree.h"
+#include "AnalysisKernels.h"
+#include "Loudness.h"
+#include "SpectralAnalysis.h"
 
 constexpr int kWaveformResolution = 512;
 constexpr int kOscilloscopeBufferSize = 2048;
 constexpr float kWaveformLowCrossoverHz = 160.0f;
 constexpr float kWaveformHighCrossoverHz = 4000.0f;
+constexpr int kTruePeakOversampling = 4;
+constexpr int kOctaveBandsPerOctave = 3;
+constexpr float kOctaveBandAveragingSeconds = 0.125f;
+constexpr int kMaxMeterChannels = 16;
+constexpr int kWaveformDisplayChannels = 2;
+constexpr float kSilenceThreshold = 1.0e-5f;
+constexpr float kSilenceHoldSeconds = 1.0f;
 
 struct TransportInfo
 {
@@ -21,8 +32,54 @@ struct TransportInfo
     bool isPlaying = false;
 };
 
+struct ChannelMeterReading
+{
+    juce::String name;
+    float peak = 0.0f;
+    float truePeak = 0.0f;
+    float rms = 0.0f;
+    bool clipped = false;
+};
+
+struct ChannelPairReading
+{
+    juce::String name;
+    float correlation = 0.0f;
+};
+
 struct SharedDataSnapshot
 {
+    /** Sections fillSnapshot copies only when asked for; the scalar readings are always copied. */
+    enum Section : std::uint32_t
+    {
+        waveformData         = 1u << 0,
+        oscilloscopeData     = 1u << 1,
+        spectrumData         = 1u << 2,
+        longTermSpectrumData = 1u << 3,
+        spectrogramData      = 1u << 4,
+        lissajousData        = 1u << 5,
+        channelData          = 1u << 6,
+        octaveBandData       = 1u << 7,
+        loudnessHistoryData  = 1u << 8,
+        audioHistoryData     = 1u << 9,
+
+        allMeterData = waveformData | oscilloscopeData | spectrumData | longTermSpectrumData | spectrogramData
+                     | lissajousData | channelData | octaveBandData | loudnessHistoryData
+    };
+
+    // Change counters, each read before its section's data: a counter that has not moved since the previous
+    // fillSnapshot means that section has not changed. meterSequence covers every reading of the meter frame
+    // (levels, loudness, stereo, Lissajous, channels, octave bands).
+    std::uint64_t waveformSequence = 0;
+    std::uint64_t oscilloscopeSequence = 0;
+    std::uint64_t spectrumSequence = 0;
+    std::uint64_t longTermSpectrumSequence = 0;
+    std::uint64_t meterSequence = 0;
+    std::uint64_t loudnessHistorySequence = 0;
+
+    /** Every input channel has stayed below kSilenceThreshold for at least kSilenceHoldSeconds. */
+    bool signalSilent = false;
+
     juce::AudioBuffer<float> audioHistory;
     int writePosition = 0;
     bool bufferWrapped = false;
@@ -43,9 +100,23 @@ struct SharedDataSnapshot
     std::vector<float> oscilloscope;
 
     std::vector<float> spectrum;
-    juce::AudioBuffer<float> spectrogram;
-    int spectrogramWritePosition = 0;
-    bool spectrogramWrapped = false;
+    std::vector<float> spectrumLeft;
+    std::vector<float> spectrumRight;
+    std::vector<float> spectrumSide;
+    std::vector<float> spectrumFrequencies;
+    std::vector<float> longTermSpectrumPower;
+    std::vector<float> longTermSpectrumVariance;
+    std::uint64_t longTermSpectrumFrames = 0;
+    // spectrogram holds only the frames [spectrogramFirstFrame, spectrogramCursor) published since the previous
+    // call; fillSnapshot reads from spectrogramCursor onwards. spectrogramRestarted means the history was replaced
+    // or the cursor was overtaken, so earlier frames must be discarded.
+    SpectrogramFrames spectrogram;
+    std::uint64_t spectrogramFirstFrame = 0;
+    std::uint64_t spectrogramCursor = 0;
+    std::uint32_t spectrogramGeneration = 0;
+    int spectrogramCapacity = 0;
+    bool spectrogramRestarted = false;
+    double spectrogramSecondsPerColumn = 0.0;
 
     std::array<juce::Point<float>, 512> lissajous {};
     int lissajousCount = 0;
@@ -71,9 +142,20 @@ struct SharedDataSnapshot
     bool clipRight = false;
     float peakLeft = 0.0f;
     float peakRight = 0.0f;
+    float truePeakLeft = 0.0f;
+    float truePeakRight = 0.0f;
+    std::vector<ChannelMeterReading> channels;
+    std::vector<ChannelPairReading> channelPairs;
     double sampleRate = 48000.0;
+
+    /** Input samples the analysis never saw because its queue was full, counted since integrated loudness
+        and loudness range were last reset (prepareToPlay; the Reset button only clears the maxima).
+        Non-zero means the integrated and LRA readings are missing that audio. */
+    std::uint64_t droppedAnalysisSamples = 0;
     float loudnessHistoryInterval = 0.0f;
     std::vector<float> loudnessHistory;
+    std::vector<float> octaveBandLevels;
+    std::vector<float> octaveBandFrequencies;
     TransportInfo transport;
 };
 
@@ -84,6 +166,25 @@ struct LoudnessMeterState
     int historySeconds = 20;
 };
 
+struct SpectrumAnalysisSettings
+{
+    int fftOrder = 11;
+    int window = (int) StftAnalyzer::Window::hann;
+    int overlap = (int) StftAnalyzer::Overlap::threeQuarters;
+    bool multiResolution = false;
+    int spectrogramFormat = (int) SpectrogramFrames::Format::decibels8;
+    bool reassignedSpectrogram = false;
+
+    bool operator== (const SpectrumAnalysisSettings& other) const noexcept
+    {
+        return fftOrder == other.fftOrder && window == other.window && overlap == other.overlap
+            && multiResolution == other.multiResolution && spectrogramFormat == other.spectrogramFormat
+            && reassignedSpectrogram == other.reassignedSpectrogram;
+    }
+
+    bool operator!= (const SpectrumAnalysisSettings& other) const noexcept { return ! (*this == other); }
+};
+
 struct StereoMeterState
 {
     int viewMode = 1;
@@ -100,10 +201,10 @@ class MiniMetersCloneAudioProcessor : public juce::AudioProcessor
 {
 public:
     MiniMetersCloneAudioProcessor();
-    ~MiniMetersCloneAudioProcessor() override = default;
+    ~MiniMetersCloneAudioProcessor() override;
 
     void prepareToPlay (double sampleRate, int samplesPerBlock) override;
-    void releaseResources() override {}
+    void releaseResources() override;
     bool isBusesLayoutSupported (const BusesLayout& layouts) const override;
 
     void processBlock (juce::AudioBuffer<float>&, juce::MidiBuffer&) override;
@@ -130,7 +231,7 @@ public:
 
     void setBallistics (float riseMs, float fallMs);
 
-    void fillSnapshot (SharedDataSnapshot& snapshot, bool includeAudioHistory = false) const;
+    void fillSnapshot (SharedDataSnapshot& snapshot, std::uint32_t sections = SharedDataSnapshot::allMeterData);
 
     void setStickinessRequested (bool shouldBeOnTop) noexcept { stickRequested.store (shouldBeOnTop); }
     bool consumeStickinessRequested() noexcept { return stickRequested.exchange (false); }
@@ -143,42 +244,29 @@ public:
     StereoMeterState getStereoMeterState() const noexcept { return stereoState; }
     void setStereoMeterState (const StereoMeterState& newState) noexcept;
 
+    /** Editor frames per second while the input is active; one of 30, 60, 120 or 144. */
+    int getEditorRefreshRate() const noexcept { return editorRefreshRate; }
+    void setEditorRefreshRate (int framesPerSecond) noexcept;
+
+    /** Display-only analysis (waveform, oscilloscope, Lissajous, octave bands, spectrum traces and
+        spectrogram) runs only while at least one subscriber is registered. Loudness, peaks, the
+        long-term spectrum and the audio history keep running either way. */
+    void addDisplaySubscriber() noexcept;
+    void removeDisplaySubscriber() noexcept;
+
     void resetLoudnessStatistics() noexcept;
+    void resetLongTermSpectrum() noexcept;
+
+    SpectrumAnalysisSettings getSpectrumAnalysisSettings() const noexcept;
+    void setSpectrumAnalysisSettings (const SpectrumAnalysisSettings& newSettings);
 
 private:
     static constexpr float kLoudnessHistoryIntervalSeconds = 0.05f;
     static constexpr float kLoudnessHistorySpanSeconds = 20.0f;
 
-    struct SharedState
+    struct MeterFrame
     {
-        juce::SpinLock lock;
-        juce::AudioBuffer<float> audioHistory;
-        int writePosition = 0;
-        bool hasWrapped = false;
-
-        std::vector<float> spectrum;
-        std::vector<float> spectrumAverages;
-
-        std::vector<float> waveformMin[2];
-        std::vector<float> waveformMax[2];
-        std::array<std::array<std::vector<float>, 3>, 2> waveformBandEnergy;
-        int waveformSamplesPerBucket = 0;
-        int waveformWriteIndex = 0;
-        int waveformFilled = 0;
-        int waveformSampleCounter = 0;
-        float waveformCurrentMin[2] { 1.0f, 1.0f };
-        float waveformCurrentMax[2] { -1.0f, -1.0f };
-        std::array<std::array<float, 3>, 2> waveformBandAccum {};
-
-        std::vector<float> oscilloscopeBuffer;
-        int oscilloscopeWriteIndex = 0;
-        int oscilloscopeFilled = 0;
-
-        juce::AudioBuffer<float> spectrogramHistory;
-        int spectrogramWritePosition = 0;
-        bool spectrogramWrapped = false;
-
-        std::array<juce::Point<float>, 512> lissajousPoints;
+        std::array<juce::Point<float>, 512> lissajousPoints {};
         int lissajousCount = 0;
 
         float momentaryLufs = -100.0f;
@@ -200,81 +288,212 @@ private:
         float vuNeedleR = 0.0f;
         bool clippedL = false;
         bool clippedR = false;
+        float truePeakL = 0.0f;
+        float truePeakR = 0.0f;
+        int numChannels = 0;
+        std::array<float, kMaxMeterChannels> channelPeak {};
+        std::array<float, kMaxMeterChannels> channelTruePeak {};
+        std::array<float, kMaxMeterChannels> channelRms {};
+        std::array<bool, kMaxMeterChannels> channelClipped {};
+        int numPairs = 0;
+        std::array<float, kMaxMeterChannels / 2> pairCorrelation {};
+        int numOctaveBands = 0;
+        std::array<float, OctaveBandFilterBank::maxBands> octaveBandLevels {};
+        std::array<float, OctaveBandFilterBank::maxBands> octaveBandFrequencies {};
+        TransportInfo transport;
+        bool silent = false;
+        std::uint64_t droppedSamples = 0;
+    };
+
+    /** Spectrum magnitudes indexed by StereoStftAnalyzer::Trace; unused traces are empty. */
+    using SpectrumTraces = std::array<std::vector<float>, StereoStftAnalyzer::numTraces>;
+
+    struct LongTermSpectrumFrame
+    {
+        std::vector<float> meanPower;
+        std::vector<float> powerVariance;
+        std::uint64_t numFrames = 0;
+    };
+
+    struct WaveformChannel
+    {
+        std::vector<float> minimum;
+        std::vector<float> maximum;
+        std::array<std::vector<float>, 3> bandEnergy;
+    };
+
+    struct ChannelLayoutInfo
+    {
+        int numChannels = 0;
+        int displayLeft = 0;
+        int displayRight = 0;
+        std::array<float, kMaxMeterChannels> loudnessWeights {};
+        std::array<std::array<int, 2>, kMaxMeterChannels / 2> pairs {};
+        int numPairs = 0;
+        juce::StringArray channelNames;
+        juce::StringArray pairNames;
+    };
+
+    struct SharedState
+    {
+        juce::SpinLock layoutLock;
+
+        juce::AudioBuffer<float> audioHistory;
+        RingPublication audioHistoryRing;
+
+        juce::StringArray channelNames;
+        juce::StringArray pairNames;
+
+        std::vector<WaveformChannel> waveform;
+        int waveformSamplesPerBucket = 0;
+        RingPublication waveformRing;
+
+        std::vector<float> oscilloscopeBuffer;
+        RingPublication oscilloscopeRing;
+
+        SpectrogramFrames spectrogramHistory;
+        RingPublication spectrogramRing;
+        std::uint32_t spectrogramGeneration = 0;
+        double spectrogramSecondsPerColumn = 0.0;
+        std::vector<float> spectrumFrequencies;
+
         std::vector<float> loudnessHistory;
-        int loudnessHistoryWrite = 0;
-        int loudnessHistoryFilled = 0;
+        RingPublication loudnessHistoryRing;
         float loudnessHistoryInterval = kLoudnessHistoryIntervalSeconds;
-        TransportInfo transport;
+
+        TripleBuffer<SpectrumTraces> spectrum;
+        TripleBuffer<LongTermSpectrumFrame> longTermSpectrum;
+        TripleBuffer<MeterFrame> meters;
     } shared;
 
     mutable std::atomic<bool> stickRequested { false };
+    std::atomic<bool> loudnessResetRequested { false };
+    std::atomic<bool> longTermSpectrumResetRequested { false };
+    std::atomic<int> displaySubscribers { 0 };
 
     float sampleRate = 48000.0f;
 
     float peakRiseCoeff = 0.0f, peakFallCoeff = 0.0f;
     float rmsCoeff = 0.0f;
 
-    float momentaryCoeff = 0.0f, shortTermCoeff = 0.0f;
     float rmsFastCoeff = 0.0f, rmsSlowCoeff = 0.0f;
     float vuCoeff = 0.0f;
 
-    int integratedBlockSamples = 0;
-    double integratedEnergyAccumulator = 0.0;
-    int integratedSampleCounter = 0;
-    std::vector<float> integratedBlockEnergies;
-    size_t integratedWriteIndex = 0;
-    size_t integratedFilled = 0;
-    std::vector<float> integratedScratch;
+    LoudnessEngine loudnessEngine;
 
     int loudnessHistoryIntervalSamples = 0;
     int loudnessHistorySampleCounter = 0;
     int loudnessHistoryCapacity = 0;
-    std::vector<float> shortTermHistoryBuffer;
-    size_t shortTermHistoryWriteIndex = 0;
-    size_t shortTermHistoryFilled = 0;
-    std::vector<float> shortTermScratch;
-
-    float integratedLoudness = -100.0f;
-    float loudnessRangeValue = 0.0f;
-    float maxMomentaryLufs = -100.0f;
-    float maxShortTermLufs = -100.0f;
 
-    juce::dsp::FFT fft { 11 };
-    juce::dsp::WindowingFunction<float> window { (size_t) 1u << 11, juce::dsp::WindowingFunction<float>::hann, true };
-    std::vector<float> fftInput;
-    std::vector<float> fftScratch;
-    std::vector<float> fftSpectrumFrame;
-    int fftInputPos = 0;
-    int fftHop = 512;
-
-    juce::dsp::IIR::Filter<float> kPreFilter;
-    juce::dsp::IIR::Filter<float> kHighpass;
-    std::array<juce::dsp::IIR::Filter<float>, 2> waveformLowFilters;
-    std::array<juce::dsp::IIR::Filter<float>, 2> waveformMidHighFilters;
-    std::array<juce::dsp::IIR::Filter<float>, 2> waveformMidLowFilters;
-    std::array<juce::dsp::IIR::Filter<float>, 2> waveformHighFilters;
+    /** Everything whose size depends on the spectrum settings, allocated together so the
+        analysis thread can switch resolution by swapping pointers. */
+    struct SpectrumEngine
+    {
+        bool useMultiResolution = false;
+        bool useReassignment = false;
+        StereoStftAnalyzer stft;
+        MultiResolutionAnalyzer multiResolution;
+        ReassignedStftAnalyzer reassigned;
+        std::vector<float> binFrequencies;
+        SpectrumTraces averages;
+        LongTermSpectrum longTerm;
+        SpectrogramFrames spectrogramHistory;
+        std::array<SpectrumTraces, 3> spectrumFrames;
+        std::array<LongTermSpectrumFrame, 3> longTermFrames;
+        double secondsPerColumn = 0.0;
+    };
+
+    /** Builds a SpectrumEngine for the latest settings whenever it is notified. */
+    class SpectrumEngineBuilder : public juce::Thread
+    {
+    public:
+        explicit SpectrumEngineBuilder (MiniMetersCloneAudioProcessor& p) : juce::Thread ("EasyMeter Spectrum Builder"), owner (p) {}
+        void run() override;
+
+    private:
+        MiniMetersCloneAudioProcessor& owner;
+    };
+
+    static constexpr float kMultiResolutionFinestHz = 1.0f;
+
+    static std::unique_ptr<SpectrumEngine> createSpectrumEngine (const SpectrumAnalysisSettings& settings, double sampleRate);
+    void buildRequestedSpectrumEngine();
+    /** Swaps engine's buffers into the shared state and makes it current, leaving engine empty. Without
+        waitForLock it gives up, returning false with engine untouched, while fillSnapshot holds the lock. */
+    bool installSpectrumEngine (std::unique_ptr<SpectrumEngine>& engine, bool waitForLock);
+    void installPendingSpectrumEngine();
+    void discardQueuedSpectrumEngines();
+
+    juce::SpinLock spectrumSettingsLock;
+    SpectrumAnalysisSettings spectrumSettings;
+    std::unique_ptr<SpectrumEngine> spectrumEngine;
+    std::atomic<SpectrumEngine*> pendingSpectrumEngine { nullptr };
+    std::atomic<SpectrumEngine*> retiredSpectrumEngine { nullptr };
+    std::unique_ptr<SpectrumEngine> stagedSpectrumEngine;
+    SpectrumEngineBuilder spectrumEngineBuilder { *this };
+
+    ChannelLayoutInfo channelLayout;
+    KWeightingFilterBank kWeighting;
+    WaveformBandFilterBank waveformBands;
+    TruePeakDetector truePeakDetector;
+    OctaveBandFilterBank octaveBands;
+    std::array<float, kMaxMeterChannels> channelPeakHold {};
+    std::array<float, kMaxMeterChannels> maxChannelTruePeak {};
 
     TransportInfo lastTransportInfo;
+    bool longTermTransportWasPlaying = false;
+    bool displayAnalysisActive = false;
+
+    /** Runs the analysis stages on blocks the audio thread queued in analysisFifo. */
+    class AnalysisWorker : public juce::Thread
+    {
+    public:
+        explicit AnalysisWorker (MiniMetersCloneAudioProcessor& p) : juce::Thread ("EasyMeter Analysis"), owner (p) {}
+        void run() override;
+
+    private:
+        MiniMetersCloneAudioProcessor& owner;
+    };
+
+    static constexpr int kAnalysisPollIntervalMs = 5;
+
+    // The queue holds this much audio, enough to ride out scheduling stalls and the slowest analysis
+    // blocks, in host blocks as short as kAnalysisMinBlockSamples before realtime input is dropped.
+    static constexpr double kAnalysisMaxLagSeconds = 2.0;
+    static constexpr int kAnalysisMinBlockSamples = 32;
+
+    std::atomic<std::uint64_t> droppedAnalysisSamples { 0 };
+
+    AudioBlockFifo<TransportInfo> analysisFifo;
+    juce::AudioBuffer<float> analysisBuffer;
+    AnalysisWorker analysisWorker { *this };
 
     juce::AudioBuffer<float> monoScratch;
+    juce::AudioBuffer<float> kWeightedScratch;
+
+    int waveformSampleCounter = 0;
+    float waveformCurrentMin[2] { 1.0f, 1.0f };
+    float waveformCurrentMax[2] { -1.0f, -1.0f };
+    std::array<std::array<float, 3>, 2> waveformBandAccum {};
 
-    float momentaryEnergy = 1.0e-9f;
-    float shortTermEnergy = 1.0e-9f;
     float rmsFastEnergy = 1.0e-9f;
     float rmsSlowEnergy = 1.0e-9f;
     float vuEnergyL = 0.0f;
     float vuEnergyR = 0.0f;
+    int silentSamples = 0;
 
     LoudnessMeterState loudnessState {};
     StereoMeterState stereoState {};
+    int editorRefreshRate = 60;
 
     void initialiseSharedState();
     void updateBallistics();
-    void pushIntegratedBlock (float energy);
-    void updateIntegratedMetrics();
-    void pushShortTermHistoryValue (float value);
-    void updateLoudnessRange();
-    static float energyToLoudness (float energy) noexcept;
+    void applyPendingLoudnessReset() noexcept;
+    void primeDisplayAnalysis();
+    void drainAnalysisFifo();
+    void analyseBlock (const juce::AudioBuffer<float>& buffer, int numSamples, const TransportInfo& transportForBlock);
+    void analyseSpectrum (const float* left, const float* right, const float* mono, int numSamples, bool displayActive);
+    static ChannelLayoutInfo describeChannelLayout (const juce::AudioChannelSet& layout);
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (MiniMetersCloneAudioProcessor)
 };
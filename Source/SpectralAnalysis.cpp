@@ -0,0 +1,603 @@
+#include "SpectralAnalysis.h"
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+    constexpr float decibels8Floor = -127.5f;
+    constexpr float decibels8Step = 0.5f;
+    constexpr float decibels16Floor = -200.0f;
+    constexpr float decibels16Step = 1.0f / 256.0f;
+}
+
+SpectrogramFrames& SpectrogramFrames::operator= (const SpectrogramFrames& other)
+{
+    if (this != &other)
+    {
+        setSize (other.numFrames, other.frameSize, other.format);
+        std::copy_n (other.getFrameData (0), (size_t) numFrames * stride, getFrameData (0));
+    }
+
+    return *this;
+}
+
+void SpectrogramFrames::setSize (int newNumFrames, int newFrameSize, Format newFormat)
+{
+    numFrames = juce::jmax (0, newNumFrames);
+    frameSize = juce::jmax (0, newFrameSize);
+    format = newFormat;
+
+    const size_t bytesPerValue = format == Format::decibels8 ? 1 : 2;
+    stride = ((size_t) frameSize * bytesPerValue + alignmentBytes - 1) / alignmentBytes * alignmentBytes;
+
+    const size_t required = (size_t) numFrames * stride + alignmentBytes;
+    if (storage.size() < required)
+        storage.resize (required);
+
+    realign();
+}
+
+void SpectrogramFrames::realign() noexcept
+{
+    const auto address = reinterpret_cast<std::uintptr_t> (storage.data());
+    offset = (alignmentBytes - address % alignmentBytes) % alignmentBytes;
+}
+
+void SpectrogramFrames::clear() noexcept
+{
+    std::fill (storage.begin(), storage.end(), (std::uint8_t) 0);
+}
+
+float SpectrogramFrames::codeToDecibels (int code) const noexcept
+{
+    if (format == Format::decibels8)
+        return decibels8Floor + decibels8Step * (float) code;
+
+    return decibels16Floor + decibels16Step * (float) code;
+}
+
+void SpectrogramFrames::writeFrame (int index, const float* magnitudes, int count) noexcept
+{
+    count = juce::jmin (count, frameSize);
+    const float floor = format == Format::decibels8 ? decibels8Floor : decibels16Floor;
+    const float codesPerDecibel = 1.0f / (format == Format::decibels8 ? decibels8Step : decibels16Step);
+    const float maxCode = (float) getMaxCode();
+
+    auto quantise = [&] (float magnitude)
+    {
+        const float decibels = 20.0f * std::log10 (juce::jmax (magnitude, 1.0e-12f));
+        return juce::jlimit (0.0f, maxCode, (decibels - floor) * codesPerDecibel + 0.5f);
+    };
+
+    if (format == Format::decibels8)
+    {
+        auto* codes = getFrameData (index);
+        for (int bin = 0; bin < count; ++bin)
+            codes[bin] = (std::uint8_t) quantise (magnitudes[bin]);
+    }
+    else
+    {
+        auto* codes = reinterpret_cast<std::uint16_t*> (getFrameData (index));
+        for (int bin = 0; bin < count; ++bin)
+            codes[bin] = (std::uint16_t) quantise (magnitudes[bin]);
+    }
+}
+
+void SpectrogramFrames::copyFromRing (const SpectrogramFrames& ring, std::uint64_t first, int count)
+{
+    setSize (count, ring.frameSize, ring.format);
+    if (count <= 0 || ring.numFrames <= 0)
+        return;
+
+    int source = (int) (first % (std::uint64_t) ring.numFrames);
+    int copied = 0;
+    while (copied < count)
+    {
+        const int chunk = juce::jmin (count - copied, ring.numFrames - source);
+        std::copy_n (ring.getFrameData (source), (size_t) chunk * stride, getFrameData (copied));
+        copied += chunk;
+        source = 0;
+    }
+}
+
+void SpectrogramFrames::copyIntoRing (const SpectrogramFrames& source, std::uint64_t first) noexcept
+{
+    jassert (source.frameSize == frameSize && source.format == format);
+    if (numFrames <= 0)
+        return;
+
+    const int count = juce::jmin (source.numFrames, numFrames);
+    const int skipped = source.numFrames - count;
+    int destination = (int) ((first + (std::uint64_t) skipped) % (std::uint64_t) numFrames);
+    int copied = 0;
+    while (copied < count)
+    {
+        const int chunk = juce::jmin (count - copied, numFrames - destination);
+        std::copy_n (source.getFrameData (skipped + copied), (size_t) chunk * stride, getFrameData (destination));
+        copied += chunk;
+        destination = 0;
+    }
+}
+
+void SpectrogramFrames::dropOldestFrames (int count) noexcept
+{
+    if (count <= 0)
+        return;
+
+    const int remaining = juce::jmax (0, numFrames - count);
+    if (remaining > 0)
+        std::copy_n (getFrameData (count), (size_t) remaining * stride, getFrameData (0));
+
+    numFrames = remaining;
+}
+
+void StftAnalyzer::prepare (int fftOrder, Overlap overlap, Window windowType)
+{
+    fft = std::make_unique<juce::dsp::FFT> (juce::jlimit (minFftOrder, maxFftOrder, fftOrder));
+    fftSize = fft->getSize();
+    hopSize = juce::jmax (1, fftSize / (int) overlap);
+
+    fillWindow (window, fftSize, windowType);
+
+    ring.assign ((size_t) fftSize, 0.0f);
+    frame.assign ((size_t) fftSize * 2, 0.0f);
+    reset();
+}
+
+void StftAnalyzer::fillWindow (std::vector<float>& window, int size, Window windowType)
+{
+    using Windowing = juce::dsp::WindowingFunction<float>;
+    auto method = Windowing::hann;
+    switch (windowType)
+    {
+        case Window::blackmanHarris: method = Windowing::blackmanHarris; break;
+        case Window::flatTop:        method = Windowing::flatTop; break;
+        case Window::kaiser:         method = Windowing::kaiser; break;
+        case Window::hann:           break;
+    }
+
+    // Normalised windows keep a full-scale sine at the same level whichever window is chosen.
+    window.resize ((size_t) size);
+    Windowing::fillWindowingTables (window.data(), (size_t) size, method, true, 9.0f);
+}
+
+void StftAnalyzer::reset() noexcept
+{
+    std::fill (ring.begin(), ring.end(), 0.0f);
+    std::fill (frame.begin(), frame.end(), 0.0f);
+    writePosition = 0;
+    samplesUntilHop = hopSize;
+}
+
+void StftAnalyzer::write (const float* samples, int numSamples) noexcept
+{
+    while (numSamples > 0)
+    {
+        const int toCopy = juce::jmin (numSamples, fftSize - writePosition);
+        std::copy (samples, samples + toCopy, ring.data() + writePosition);
+        samples += toCopy;
+        numSamples -= toCopy;
+        writePosition = (writePosition + toCopy) % fftSize;
+    }
+}
+
+const float* StftAnalyzer::computeFrame() noexcept
+{
+    const int olderCount = fftSize - writePosition;
+    juce::FloatVectorOperations::multiply (frame.data(), ring.data() + writePosition, window.data(), olderCount);
+    juce::FloatVectorOperations::multiply (frame.data() + olderCount, ring.data(), window.data() + olderCount, writePosition);
+
+    fft->performFrequencyOnlyForwardTransform (frame.data(), true);
+    juce::FloatVectorOperations::multiply (frame.data(), 1.0f / (float) fftSize, getNumBins());
+    return frame.data();
+}
+
+void StereoStftAnalyzer::prepare (int fftOrder, StftAnalyzer::Overlap overlap, StftAnalyzer::Window windowType)
+{
+    fft = std::make_unique<juce::dsp::FFT> (juce::jlimit (StftAnalyzer::minFftOrder, StftAnalyzer::maxFftOrder, fftOrder));
+    fftSize = fft->getSize();
+    hopSize = juce::jmax (1, fftSize / (int) overlap);
+    StftAnalyzer::fillWindow (window, fftSize, windowType);
+
+    leftRing.assign ((size_t) fftSize, 0.0f);
+    rightRing.assign ((size_t) fftSize, 0.0f);
+    leftWindowed.assign ((size_t) fftSize, 0.0f);
+    rightWindowed.assign ((size_t) fftSize, 0.0f);
+    packed.assign ((size_t) fftSize, {});
+    spectrum.assign ((size_t) fftSize, {});
+    magnitudes.assign ((size_t) (numTraces * getNumBins()), 0.0f);
+
+    for (int trace = 0; trace < numTraces; ++trace)
+        tracePointers[(size_t) trace] = magnitudes.data() + trace * getNumBins();
+
+    reset();
+}
+
+void StereoStftAnalyzer::reset() noexcept
+{
+    std::fill (leftRing.begin(), leftRing.end(), 0.0f);
+    std::fill (rightRing.begin(), rightRing.end(), 0.0f);
+    std::fill (magnitudes.begin(), magnitudes.end(), 0.0f);
+    writePosition = 0;
+    samplesUntilHop = hopSize;
+}
+
+void StereoStftAnalyzer::write (const float* leftSamples, const float* rightSamples, int numSamples) noexcept
+{
+    while (numSamples > 0)
+    {
+        const int toCopy = juce::jmin (numSamples, fftSize - writePosition);
+        std::copy (leftSamples, leftSamples + toCopy, leftRing.data() + writePosition);
+        std::copy (rightSamples, rightSamples + toCopy, rightRing.data() + writePosition);
+        leftSamples += toCopy;
+        rightSamples += toCopy;
+        numSamples -= toCopy;
+        writePosition = (writePosition + toCopy) % fftSize;
+    }
+}
+
+void StereoStftAnalyzer::computeFrame() noexcept
+{
+    const int olderCount = fftSize - writePosition;
+    juce::FloatVectorOperations::multiply (leftWindowed.data(), leftRing.data() + writePosition, window.data(), olderCount);
+    juce::FloatVectorOperations::multiply (leftWindowed.data() + olderCount, leftRing.data(), window.data() + olderCount, writePosition);
+    juce::FloatVectorOperations::multiply (rightWindowed.data(), rightRing.data() + writePosition, window.data(), olderCount);
+    juce::FloatVectorOperations::multiply (rightWindowed.data() + olderCount, rightRing.data(), window.data() + olderCount, writePosition);
+
+    for (int i = 0; i < fftSize; ++i)
+        packed[(size_t) i] = { leftWindowed[(size_t) i], rightWindowed[(size_t) i] };
+
+    fft->perform (packed.data(), spectrum.data(), false);
+
+    // With X = FFT (l + i r): L[k] = (X[k] + conj X[N-k]) / 2 and R[k] = (X[k] - conj X[N-k]) / 2i.
+    // Mid and side follow as (L + R) / 2 and (L - R) / 2; the 1 / N keeps the mono path's scaling.
+    const int bins = getNumBins();
+    const float scale = 0.5f / (float) fftSize;
+    float* midOut = magnitudes.data() + mid * bins;
+    float* leftOut = magnitudes.data() + left * bins;
+    float* rightOut = magnitudes.data() + right * bins;
+    float* sideOut = magnitudes.data() + side * bins;
+
+    for (int k = 0; k < bins; ++k)
+    {
+        const auto x = spectrum[(size_t) k];
+        const auto mirrored = std::conj (spectrum[(size_t) ((fftSize - k) % fftSize)]);
+        const auto l = (x + mirrored) * scale;
+        const auto sum = x - mirrored;
+        const std::complex<float> r (sum.imag() * scale, -sum.real() * scale);
+
+        leftOut[k] = std::abs (l);
+        rightOut[k] = std::abs (r);
+        midOut[k] = 0.5f * std::abs (l + r);
+        sideOut[k] = 0.5f * std::abs (l - r);
+    }
+}
+
+void ReassignedStftAnalyzer::prepare (int fftOrder, StftAnalyzer::Overlap overlap, StftAnalyzer::Window windowType)
+{
+    fft = std::make_unique<juce::dsp::FFT> (juce::jlimit (StftAnalyzer::minFftOrder, StftAnalyzer::maxFftOrder, fftOrder));
+    fftSize = fft->getSize();
+    hopSize = juce::jmax (1, fftSize / (int) overlap);
+    StftAnalyzer::fillWindow (window, fftSize, windowType);
+
+    // Time ramp centred on the frame and a central-difference derivative, both in samples.
+    timeWindow.resize ((size_t) fftSize);
+    derivativeWindow.resize ((size_t) fftSize);
+    for (int i = 0; i < fftSize; ++i)
+    {
+        const float previous = i > 0 ? window[(size_t) i - 1] : 0.0f;
+        const float next = i + 1 < fftSize ? window[(size_t) i + 1] : 0.0f;
+        timeWindow[(size_t) i] = (float) (i - fftSize / 2) * window[(size_t) i];
+        derivativeWindow[(size_t) i] = 0.5f * (next - previous);
+    }
+
+    maxColumnOffset = (fftSize / 2 + hopSize - 1) / hopSize;
+    ring.assign ((size_t) fftSize, 0.0f);
+    frame.assign ((size_t) fftSize, 0.0f);
+    windowed.assign ((size_t) fftSize, 0.0f);
+    derivativeWindowed.assign ((size_t) fftSize, 0.0f);
+    packed.assign ((size_t) fftSize, {});
+    spectrum.assign ((size_t) fftSize, {});
+    timeSpectrum.assign ((size_t) fftSize, {});
+    columns.assign ((size_t) ((2 * maxColumnOffset + 1) * getNumBins()), 0.0f);
+    magnitudes.assign ((size_t) getNumBins(), 0.0f);
+    reset();
+}
+
+void ReassignedStftAnalyzer::reset() noexcept
+{
+    std::fill (ring.begin(), ring.end(), 0.0f);
+    std::fill (columns.begin(), columns.end(), 0.0f);
+    std::fill (magnitudes.begin(), magnitudes.end(), 0.0f);
+    writePosition = 0;
+    samplesUntilHop = hopSize;
+    frameCounter = 0;
+}
+
+void ReassignedStftAnalyzer::write (const float* samples, int numSamples) noexcept
+{
+    while (numSamples > 0)
+    {
+        const int toCopy = juce::jmin (numSamples, fftSize - writePosition);
+        std::copy (samples, samples + toCopy, ring.data() + writePosition);
+        samples += toCopy;
+        numSamples -= toCopy;
+        writePosition = (writePosition + toCopy) % fftSize;
+    }
+}
+
+const float* ReassignedStftAnalyzer::computeFrame() noexcept
+{
+    const int olderCount = fftSize - writePosition;
+    std::copy (ring.begin() + writePosition, ring.end(), frame.begin());
+    std::copy (ring.begin(), ring.begin() + writePosition, frame.begin() + olderCount);
+
+    juce::FloatVectorOperations::multiply (windowed.data(), frame.data(), window.data(), fftSize);
+    juce::FloatVectorOperations::multiply (derivativeWindowed.data(), frame.data(), derivativeWindow.data(), fftSize);
+    for (int i = 0; i < fftSize; ++i)
+        packed[(size_t) i] = { windowed[(size_t) i], derivativeWindowed[(size_t) i] };
+    fft->perform (packed.data(), spectrum.data(), false);
+
+    juce::FloatVectorOperations::multiply (windowed.data(), frame.data(), timeWindow.data(), fftSize);
+    for (int i = 0; i < fftSize; ++i)
+        packed[(size_t) i] = { windowed[(size_t) i], 0.0f };
+    fft->perform (packed.data(), timeSpectrum.data(), false);
+
+    const int bins = getNumBins();
+    const int numColumns = 2 * maxColumnOffset + 1;
+    auto columnFor = [this, numColumns, bins] (std::uint64_t frameIndex)
+    {
+        return columns.data() + (size_t) (frameIndex % (std::uint64_t) numColumns) * (size_t) bins;
+    };
+
+    const std::uint64_t current = frameCounter++ + (std::uint64_t) maxColumnOffset;
+    std::fill (columnFor (current + (std::uint64_t) maxColumnOffset), columnFor (current + (std::uint64_t) maxColumnOffset) + bins, 0.0f);
+
+    const float scale = 1.0f / (float) fftSize;
+    const float binsPerRadian = (float) fftSize / juce::MathConstants<float>::twoPi;
+    const float columnsPerSample = 1.0f / (float) hopSize;
+
+    for (int k = 0; k < bins; ++k)
+    {
+        // Unpack X (window) and X_dh (derivative window) from the shared transform.
+        const auto z = spectrum[(size_t) k];
+        const auto mirrored = std::conj (spectrum[(size_t) ((fftSize - k) % fftSize)]);
+        const auto x = 0.5f * (z + mirrored);
+        const auto difference = z - mirrored;
+        const std::complex<float> derivative (0.5f * difference.imag(), -0.5f * difference.real());
+
+        const float power = std::norm (x);
+        if (power < 1.0e-20f)
+            continue;
+
+        const auto conjugate = std::conj (x);
+        const float binShift = -binsPerRadian * (derivative * conjugate).imag() / power;
+        const float sampleShift = (timeSpectrum[(size_t) k] * conjugate).real() / power;
+
+        const int targetBin = juce::roundToInt ((float) k + binShift);
+        const int columnShift = juce::roundToInt (sampleShift * columnsPerSample);
+        if (! juce::isPositiveAndBelow (targetBin, bins) || std::abs (columnShift) > maxColumnOffset)
+            continue;
+
+        columnFor (current + (std::uint64_t) (std::int64_t) columnShift)[targetBin] += power * scale * scale;
+    }
+
+    // The column maxColumnOffset hops back can no longer receive energy from later frames.
+    const float* completed = columnFor (current - (std::uint64_t) maxColumnOffset);
+    for (int k = 0; k < bins; ++k)
+        magnitudes[(size_t) k] = std::sqrt (completed[k]);
+
+    return magnitudes.data();
+}
+
+void HalfBandDecimator::prepare()
+{
+    constexpr int halfLength = numTaps / 2;
+    std::array<float, numTaps> window {};
+    juce::dsp::WindowingFunction<float>::fillWindowingTables (window.data(), (size_t) numTaps,
+                                                              juce::dsp::WindowingFunction<float>::kaiser, false, 8.0f);
+
+    float sum = 0.0f;
+    for (size_t j = 0; j < oddTaps.size(); ++j)
+    {
+        const int offset = 2 * (int) j + 1;
+        const float sinc = std::sin (juce::MathConstants<float>::halfPi * (float) offset) / (juce::MathConstants<float>::pi * (float) offset);
+        oddTaps[j] = sinc * window[(size_t) (halfLength + offset)];
+        sum += 2.0f * oddTaps[j];
+    }
+
+    // A half-band filter has unity DC gain when the odd taps add up to the centre tap (0.5).
+    for (auto& tap : oddTaps)
+        tap *= 0.5f / sum;
+
+    reset();
+}
+
+void HalfBandDecimator::reset() noexcept
+{
+    history.fill (0.0f);
+    historyPosition = 0;
+    skipNextOutput = false;
+}
+
+int HalfBandDecimator::process (const float* input, int numSamples, float* output) noexcept
+{
+    constexpr int centre = numTaps / 2;
+    int written = 0;
+
+    for (int i = 0; i < numSamples; ++i)
+    {
+        history[(size_t) historyPosition] = input[i];
+        history[(size_t) (historyPosition + numTaps)] = input[i];
+        const float* x = history.data() + historyPosition + 1;
+        historyPosition = (historyPosition + 1) % numTaps;
+
+        skipNextOutput = ! skipNextOutput;
+        if (! skipNextOutput)
+            continue;
+
+        float y = 0.5f * x[centre];
+        for (size_t j = 0; j < oddTaps.size(); ++j)
+        {
+            const int offset = 2 * (int) j + 1;
+            y += oddTaps[j] * (x[centre - offset] + x[centre + offset]);
+        }
+
+        output[written++] = y;
+    }
+
+    return written;
+}
+
+void MultiResolutionAnalyzer::prepare (double sampleRate, int fftOrder, StftAnalyzer::Overlap overlap,
+                                       StftAnalyzer::Window windowType, float finestResolutionHz)
+{
+    constexpr int maxDecimations = 8;
+    const int fftSize = 1 << juce::jlimit (StftAnalyzer::minFftOrder, StftAnalyzer::maxFftOrder, fftOrder);
+
+    int numDecimations = 0;
+    while (numDecimations < maxDecimations && sampleRate / (double) (fftSize << numDecimations) > (double) finestResolutionHz)
+        ++numDecimations;
+
+    stages.resize ((size_t) numDecimations + 1);
+    for (auto& stage : stages)
+        stage.prepare (fftOrder, overlap, windowType);
+
+    decimators.resize ((size_t) numDecimations);
+    for (auto& decimator : decimators)
+        decimator.prepare();
+
+    decimated.assign ((size_t) numDecimations, std::vector<float> ((size_t) maxChunkSize / 2 + 1, 0.0f));
+
+    // Stage k runs at sampleRate / 2^k and is trusted from 0.2 of its rate upwards, which keeps
+    // every point clear of the decimator's transition band (0.2 .. 0.3 of the input rate).
+    const double nyquist = sampleRate * 0.5;
+    const int numPoints = juce::jmax (1, (int) std::floor (std::log2 (nyquist / (double) lowestFrequency) * pointsPerOctave) + 1);
+    const int binsPerStage = fftSize / 2;
+    const double halfPointWidth = std::exp2 (0.5 / (double) pointsPerOctave);
+
+    points.resize ((size_t) numPoints);
+    frequencies.resize ((size_t) numPoints);
+
+    for (int i = 0; i < numPoints; ++i)
+    {
+        const double frequency = (double) lowestFrequency * std::exp2 ((double) i / (double) pointsPerOctave);
+
+        int stage = 0;
+        while (stage < numDecimations && frequency < 0.2 * sampleRate / (double) (1 << stage))
+            ++stage;
+
+        const double binWidth = sampleRate / (double) (1 << stage) / (double) fftSize;
+        const double centreBin = frequency / binWidth;
+        const double lowBin = frequency / halfPointWidth / binWidth;
+        const double highBin = frequency * halfPointWidth / binWidth;
+
+        auto& point = points[(size_t) i];
+        point.stage = stage;
+
+        if (highBin - lowBin < 1.0)
+        {
+            point.firstBin = juce::jlimit (0, binsPerStage - 2, (int) std::floor (centreBin));
+            point.fraction = juce::jlimit (0.0f, 1.0f, (float) (centreBin - (double) point.firstBin));
+            point.lastBin = -1;
+        }
+        else
+        {
+            point.firstBin = juce::jlimit (0, binsPerStage - 1, (int) std::ceil (lowBin));
+            point.lastBin = juce::jlimit (point.firstBin, binsPerStage - 1, (int) std::floor (highBin));
+        }
+
+        frequencies[(size_t) i] = (float) frequency;
+    }
+
+    merged.assign ((size_t) numPoints, 0.0f);
+    reset();
+}
+
+void MultiResolutionAnalyzer::reset() noexcept
+{
+    for (auto& stage : stages)
+        stage.reset();
+
+    for (auto& decimator : decimators)
+        decimator.reset();
+
+    std::fill (merged.begin(), merged.end(), 0.0f);
+}
+
+void MultiResolutionAnalyzer::feedDecimatedStages (const float* samples, int numSamples) noexcept
+{
+    const float* input = samples;
+    int count = numSamples;
+
+    for (size_t k = 0; k < decimators.size(); ++k)
+    {
+        count = decimators[k].process (input, count, decimated[k].data());
+        stages[k + 1].process (decimated[k].data(), count, [] (const float*) {});
+        input = decimated[k].data();
+    }
+}
+
+const float* MultiResolutionAnalyzer::mergeStages() noexcept
+{
+    for (size_t i = 0; i < points.size(); ++i)
+    {
+        const auto& point = points[i];
+        const float* magnitudes = stages[(size_t) point.stage].getMagnitudes();
+
+        if (point.lastBin < 0)
+        {
+            const float lower = magnitudes[point.firstBin];
+            merged[i] = lower + point.fraction * (magnitudes[point.firstBin + 1] - lower);
+            continue;
+        }
+
+        // Wide points keep the strongest bin so tones read at their true level.
+        float peak = 0.0f;
+        for (int bin = point.firstBin; bin <= point.lastBin; ++bin)
+            peak = juce::jmax (peak, magnitudes[bin]);
+
+        merged[i] = peak;
+    }
+
+    return merged.data();
+}
+
+void LongTermSpectrum::prepare (int numBins)
+{
+    mean.assign ((size_t) juce::jmax (0, numBins), 0.0);
+    sumSquaredDeviations.assign (mean.size(), 0.0);
+    numFrames = 0;
+}
+
+void LongTermSpectrum::reset() noexcept
+{
+    std::fill (mean.begin(), mean.end(), 0.0);
+    std::fill (sumSquaredDeviations.begin(), sumSquaredDeviations.end(), 0.0);
+    numFrames = 0;
+}
+
+void LongTermSpectrum::addFrame (const float* magnitudes) noexcept
+{
+    ++numFrames;
+    const double weight = 1.0 / (double) numFrames;
+
+    for (size_t bin = 0; bin < mean.size(); ++bin)
+    {
+        const double power = (double) magnitudes[bin] * (double) magnitudes[bin];
+        const double delta = power - mean[bin];
+        mean[bin] += delta * weight;
+        sumSquaredDeviations[bin] += delta * (power - mean[bin]);
+    }
+}
+
+void LongTermSpectrum::getPowerStatistics (float* meanPower, float* powerVariance) const noexcept
+{
+    const double weight = numFrames > 1 ? 1.0 / (double) (numFrames - 1) : 0.0;
+
+    for (size_t bin = 0; bin < mean.size(); ++bin)
+    {
+        meanPower[bin] = (float) mean[bin];
+        powerVariance[bin] = (float) (sumSquaredDeviations[bin] * weight);
+    }
+}
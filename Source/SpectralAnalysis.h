@@ -0,0 +1,368 @@
+#pragma once
+#include <JuceHeader.h>
+#include <array>
+#include <complex>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+/** Frame-major spectrogram storage: every frame is one contiguous row starting on a 64-byte
+    boundary, so frames are written, ring-copied and scanned with straight block copies.
+    The producer treats it as a ring indexed by frame; readers get frames oldest first.
+
+    Magnitudes are stored as quantised decibels, converted once when a frame is written:
+    8-bit codes cover -127.5 .. 0 dB in 0.5 dB steps, 16-bit codes cover -200 .. +56 dB in
+    1/256 dB steps. Readers map codes straight to colours without any per-value log. */
+class SpectrogramFrames
+{
+public:
+    enum class Format
+    {
+        decibels8 = 1,
+        decibels16
+    };
+
+    SpectrogramFrames() = default;
+    SpectrogramFrames (const SpectrogramFrames& other) { *this = other; }
+    SpectrogramFrames (SpectrogramFrames&&) noexcept = default;
+    SpectrogramFrames& operator= (const SpectrogramFrames& other);
+    SpectrogramFrames& operator= (SpectrogramFrames&&) noexcept = default;
+
+    /** Keeps the existing allocation whenever it is large enough. */
+    void setSize (int newNumFrames, int newFrameSize, Format newFormat);
+    void clear() noexcept;
+
+    int getNumFrames() const noexcept { return numFrames; }
+    int getFrameSize() const noexcept { return frameSize; }
+    Format getFormat() const noexcept { return format; }
+
+    /** Largest code of the current format. */
+    int getMaxCode() const noexcept { return format == Format::decibels8 ? 255 : 65535; }
+    float codeToDecibels (int code) const noexcept;
+
+    /** Quantises count linear magnitudes into frame index. */
+    void writeFrame (int index, const float* magnitudes, int count) noexcept;
+
+    const std::uint8_t* getFrame8 (int index) const noexcept { return getFrameData (index); }
+    const std::uint16_t* getFrame16 (int index) const noexcept { return reinterpret_cast<const std::uint16_t*> (getFrameData (index)); }
+
+    /** Resizes to count frames and fills them with ring frames first, first + 1, ... (modulo its size). */
+    void copyFromRing (const SpectrogramFrames& ring, std::uint64_t first, int count);
+
+    /** Writes every frame of source into this ring at frames first, first + 1, ... (modulo its size). Layouts must match. */
+    void copyIntoRing (const SpectrogramFrames& source, std::uint64_t first) noexcept;
+
+    /** Removes the oldest count frames, moving the rest to the front. */
+    void dropOldestFrames (int count) noexcept;
+
+private:
+    static constexpr size_t alignmentBytes = 64;
+
+    std::uint8_t* getFrameData (int index) noexcept { return storage.data() + offset + (size_t) index * stride; }
+    const std::uint8_t* getFrameData (int index) const noexcept { return storage.data() + offset + (size_t) index * stride; }
+    void realign() noexcept;
+
+    std::vector<std::uint8_t> storage;
+    size_t offset = 0;
+    size_t stride = 0;
+    int numFrames = 0;
+    int frameSize = 0;
+    Format format = Format::decibels8;
+};
+
+/** Short-time Fourier transform over a circular input buffer.
+    Incoming audio is block-copied into the ring and the window is applied while each frame is
+    read back out of it, so a hop costs a single windowed pass over the frame. */
+class StftAnalyzer
+{
+public:
+    enum class Overlap
+    {
+        half = 2,
+        threeQuarters = 4,
+        sevenEighths = 8
+    };
+
+    enum class Window
+    {
+        hann = 1,
+        blackmanHarris,
+        flatTop,
+        kaiser
+    };
+
+    static constexpr int minFftOrder = 9;
+    static constexpr int maxFftOrder = 15;
+
+    void prepare (int fftOrder, Overlap overlap, Window windowType);
+    void reset() noexcept;
+
+    /** Fills window with the normalised analysis window of the given type. */
+    static void fillWindow (std::vector<float>& window, int size, Window windowType);
+
+    int getFftSize() const noexcept { return fftSize; }
+    int getNumBins() const noexcept { return fftSize / 2; }
+    int getHopSize() const noexcept { return hopSize; }
+
+    /** Adds samples and calls frameCallback (const float* magnitudes) once per completed hop. */
+    template <typename FrameCallback>
+    void process (const float* samples, int numSamples, FrameCallback&& frameCallback)
+    {
+        while (numSamples > 0)
+        {
+            const int toWrite = juce::jmin (numSamples, samplesUntilHop);
+            write (samples, toWrite);
+            samples += toWrite;
+            numSamples -= toWrite;
+            samplesUntilHop -= toWrite;
+
+            if (samplesUntilHop == 0)
+            {
+                samplesUntilHop = hopSize;
+                frameCallback (computeFrame());
+            }
+        }
+    }
+
+    /** Magnitudes of the most recent frame (zeros before the first hop). */
+    const float* getMagnitudes() const noexcept { return frame.data(); }
+
+private:
+    void write (const float* samples, int numSamples) noexcept;
+    const float* computeFrame() noexcept;
+
+    std::unique_ptr<juce::dsp::FFT> fft;
+    int fftSize = 0;
+    int hopSize = 0;
+    int samplesUntilHop = 0;
+    int writePosition = 0;
+    std::vector<float> window;
+    std::vector<float> ring;
+    std::vector<float> frame;
+};
+
+/** Left, right, mid and side spectra of a stereo signal from one complex FFT per hop.
+    The windowed channels are packed as left + i * right; the two real spectra are separated
+    using the conjugate symmetry of real transforms, and mid / side are formed from them
+    linearly, so the four traces cost one transform plus a pass over the bins. */
+class StereoStftAnalyzer
+{
+public:
+    enum Trace
+    {
+        mid = 0,
+        left,
+        right,
+        side,
+        numTraces
+    };
+
+    void prepare (int fftOrder, StftAnalyzer::Overlap overlap, StftAnalyzer::Window windowType);
+    void reset() noexcept;
+
+    int getFftSize() const noexcept { return fftSize; }
+    int getNumBins() const noexcept { return fftSize / 2; }
+    int getHopSize() const noexcept { return hopSize; }
+
+    /** Adds samples and calls frameCallback (const float* const* magnitudes), indexed by Trace,
+        once per completed hop. */
+    template <typename FrameCallback>
+    void process (const float* leftSamples, const float* rightSamples, int numSamples, FrameCallback&& frameCallback)
+    {
+        while (numSamples > 0)
+        {
+            const int toWrite = juce::jmin (numSamples, samplesUntilHop);
+            write (leftSamples, rightSamples, toWrite);
+            leftSamples += toWrite;
+            rightSamples += toWrite;
+            numSamples -= toWrite;
+            samplesUntilHop -= toWrite;
+
+            if (samplesUntilHop == 0)
+            {
+                samplesUntilHop = hopSize;
+                computeFrame();
+                frameCallback (tracePointers.data());
+            }
+        }
+    }
+
+private:
+    void write (const float* leftSamples, const float* rightSamples, int numSamples) noexcept;
+    void computeFrame() noexcept;
+
+    std::unique_ptr<juce::dsp::FFT> fft;
+    int fftSize = 0;
+    int hopSize = 0;
+    int samplesUntilHop = 0;
+    int writePosition = 0;
+    std::vector<float> window;
+    std::vector<float> leftRing;
+    std::vector<float> rightRing;
+    std::vector<float> leftWindowed;
+    std::vector<float> rightWindowed;
+    std::vector<std::complex<float>> packed;
+    std::vector<std::complex<float>> spectrum;
+    std::vector<float> magnitudes;
+    std::array<const float*, numTraces> tracePointers {};
+};
+
+/** Reassigned spectrogram columns. Besides the windowed FFT X, each hop transforms the frame with
+    the time-ramped window (t h) and the window derivative (dh/dt); every bin's power is then moved
+    to the instantaneous frequency k - N/2pi Im (X_dh / X) and group delay Re (X_th / X) it reports.
+    X and X_dh share one complex FFT through the two-real-signals packing. Columns are completed
+    once no later frame can reach them, so output lags the input by getLatencyHops() hops. */
+class ReassignedStftAnalyzer
+{
+public:
+    void prepare (int fftOrder, StftAnalyzer::Overlap overlap, StftAnalyzer::Window windowType);
+    void reset() noexcept;
+
+    int getFftSize() const noexcept { return fftSize; }
+    int getNumBins() const noexcept { return fftSize / 2; }
+    int getHopSize() const noexcept { return hopSize; }
+    int getLatencyHops() const noexcept { return maxColumnOffset; }
+
+    /** Adds samples and calls frameCallback (const float* magnitudes) with one reassigned column per hop. */
+    template <typename FrameCallback>
+    void process (const float* samples, int numSamples, FrameCallback&& frameCallback)
+    {
+        while (numSamples > 0)
+        {
+            const int toWrite = juce::jmin (numSamples, samplesUntilHop);
+            write (samples, toWrite);
+            samples += toWrite;
+            numSamples -= toWrite;
+            samplesUntilHop -= toWrite;
+
+            if (samplesUntilHop == 0)
+            {
+                samplesUntilHop = hopSize;
+                frameCallback (computeFrame());
+            }
+        }
+    }
+
+private:
+    void write (const float* samples, int numSamples) noexcept;
+    const float* computeFrame() noexcept;
+
+    std::unique_ptr<juce::dsp::FFT> fft;
+    int fftSize = 0;
+    int hopSize = 0;
+    int samplesUntilHop = 0;
+    int writePosition = 0;
+    int maxColumnOffset = 0;
+    std::uint64_t frameCounter = 0;
+    std::vector<float> window;
+    std::vector<float> timeWindow;
+    std::vector<float> derivativeWindow;
+    std::vector<float> ring;
+    std::vector<float> frame;
+    std::vector<float> windowed;
+    std::vector<float> derivativeWindowed;
+    std::vector<std::complex<float>> packed;
+    std::vector<std::complex<float>> spectrum;
+    std::vector<std::complex<float>> timeSpectrum;
+    std::vector<float> columns;
+    std::vector<float> magnitudes;
+};
+
+/** Decimate-by-two half-band FIR. Only the centre tap and the odd-offset taps are non-zero,
+    so each output costs one multiply per pair of symmetric taps. */
+class HalfBandDecimator
+{
+public:
+    void prepare();
+    void reset() noexcept;
+
+    /** Filters numSamples inputs and writes every second output; returns how many were written. */
+    int process (const float* input, int numSamples, float* output) noexcept;
+
+private:
+    static constexpr int numTaps = 47;
+
+    std::array<float, numTaps / 4 + 1> oddTaps {};
+    std::array<float, numTaps * 2> history {};
+    int historyPosition = 0;
+    bool skipNextOutput = false;
+};
+
+/** Constant-Q style spectrum built from a cascade of STFTs.
+    Stage 0 analyses the input at full rate; each further stage analyses the output of a half-band
+    decimator at half the previous rate with the same FFT size, so it has twice the frequency
+    resolution for half the cost. The stages are merged into one frame of log-spaced points, each
+    read from the stage whose alias-free band contains it. */
+class MultiResolutionAnalyzer
+{
+public:
+    static constexpr int pointsPerOctave = 48;
+    static constexpr float lowestFrequency = 10.0f;
+
+    void prepare (double sampleRate, int fftOrder, StftAnalyzer::Overlap overlap, StftAnalyzer::Window windowType, float finestResolutionHz);
+    void reset() noexcept;
+
+    int getNumBins() const noexcept { return (int) points.size(); }
+    int getHopSize() const noexcept { return stages.empty() ? 0 : stages.front().getHopSize(); }
+    int getNumStages() const noexcept { return (int) stages.size(); }
+    const std::vector<float>& getBinFrequencies() const noexcept { return frequencies; }
+
+    /** Adds samples and calls frameCallback (const float* magnitudes) once per full-rate hop. */
+    template <typename FrameCallback>
+    void process (const float* samples, int numSamples, FrameCallback&& frameCallback)
+    {
+        while (numSamples > 0)
+        {
+            const int chunk = juce::jmin (numSamples, maxChunkSize);
+            feedDecimatedStages (samples, chunk);
+            stages.front().process (samples, chunk, [&] (const float*) { frameCallback (mergeStages()); });
+            samples += chunk;
+            numSamples -= chunk;
+        }
+    }
+
+private:
+    struct Point
+    {
+        int stage = 0;
+        int firstBin = 0;
+        int lastBin = -1;
+        float fraction = 0.0f;
+    };
+
+    static constexpr int maxChunkSize = 1024;
+
+    void feedDecimatedStages (const float* samples, int numSamples) noexcept;
+    const float* mergeStages() noexcept;
+
+    std::vector<StftAnalyzer> stages;
+    std::vector<HalfBandDecimator> decimators;
+    std::vector<std::vector<float>> decimated;
+    std::vector<Point> points;
+    std::vector<float> frequencies;
+    std::vector<float> merged;
+};
+
+/** Welch long-term average spectrum: the mean and variance of every bin's power over all frames
+    added since the last reset, kept in double precision with Welford's update so each frame costs
+    the same however long the average runs. */
+class LongTermSpectrum
+{
+public:
+    void prepare (int numBins);
+    void reset() noexcept;
+
+    /** Adds one frame of linear magnitudes (getNumBins() values). */
+    void addFrame (const float* magnitudes) noexcept;
+
+    int getNumBins() const noexcept { return (int) mean.size(); }
+    std::uint64_t getNumFrames() const noexcept { return numFrames; }
+
+    /** Writes the mean power and the power variance of every bin. */
+    void getPowerStatistics (float* meanPower, float* powerVariance) const noexcept;
+
+private:
+    std::vector<double> mean;
+    std::vector<double> sumSquaredDeviations;
+    std::uint64_t numFrames = 0;
+};
@@ -9,6 +9,9 @@ SpectrogramMeter::SpectrogramMeter()
 {
     scaleBox.addItem ("Linear", (int) FrequencyScale::linear);
     scaleBox.addItem ("Log", (int) FrequencyScale::logarithmic);
+    scaleBox.addItem ("Mel", (int) FrequencyScale::mel);
+    scaleBox.addItem ("Bark", (int) FrequencyScale::bark);
+    scaleBox.addItem ("ERB", (int) FrequencyScale::erb);
     scaleBox.setSelectedId ((int) FrequencyScale::logarithmic, juce::dontSendNotification);
     scaleBox.setJustificationType (juce::Justification::centredLeft);
     scaleBox.onChange = [this]
@@ -50,8 +53,18 @@ SpectrogramMeter::SpectrogramMeter()
     freezeButton.onClick = [this]
     {
         freezeEnabled = freezeButton.getToggleState();
-        if (! freezeEnabled)
+        if (freezeEnabled)
+        {
+            // Keep the columns on screen so palette, floor and scale changes can redraw the frozen view.
+            const int capacity = spectrogramData.getNumFrames();
+            const int captured = juce::jmin (visibleColumns, capacity);
+            orderedColumns.copyFromRing (spectrogramData, (std::uint64_t) (writePosition + capacity - captured), captured);
+            imageFrameEnd = nextFrame;
+        }
+        else
+        {
             spectrogramDirty = true;
+        }
 
         refreshStatusText();
         repaint();
@@ -110,6 +123,8 @@ SpectrogramMeter::SpectrogramMeter()
     addAndMakeVisible (scaleBox);
     addAndMakeVisible (paletteBox);
     addAndMakeVisible (timeSpanBox);
+    addAndMakeVisible (analysisControls);
+    analysisControls.setShowsSpectrogramOptions (true);
     addAndMakeVisible (freezeButton);
     addAndMakeVisible (gridButton);
     addAndMakeVisible (beatGridButton);
@@ -137,21 +152,67 @@ void SpectrogramMeter::update (const SharedDataSnapshot& snapshot, const MeterTh
 
     transport = snapshot.transport;
 
+    appendSpectrogramFrames (snapshot);
+
     if (! freezeEnabled)
     {
-        spectrogramData = snapshot.spectrogram;
-        writePosition = snapshot.spectrogramWritePosition;
-        wrapped = snapshot.spectrogramWrapped;
-        spectrogramDirty = true;
+        snapshotSecondsPerColumn = snapshot.spectrogramSecondsPerColumn;
+        binFrequencies = snapshot.spectrumFrequencies;
     }
 
     if (spectrogramDirty || themeChanged || colourLutDirty)
         refreshImage();
+    else if (! freezeEnabled && nextFrame != imageFrameEnd)
+        drawNewColumns();
+    else
+        return;
 
     refreshStatusText();
     repaint();
 }
 
+void SpectrogramMeter::appendSpectrogramFrames (const SharedDataSnapshot& snapshot)
+{
+    // The ring keeps filling while frozen; the frozen view lives in orderedColumns.
+    const auto& frames = snapshot.spectrogram;
+    const auto first = snapshot.spectrogramFirstFrame;
+    const auto end = first + (std::uint64_t) frames.getNumFrames();
+
+    const bool layoutChanged = spectrogramData.getNumFrames() != snapshot.spectrogramCapacity
+                            || spectrogramData.getFrameSize() != frames.getFrameSize()
+                            || spectrogramData.getFormat() != frames.getFormat();
+
+    if (snapshot.spectrogramRestarted || layoutChanged || first > nextFrame)
+    {
+        spectrogramData.setSize (snapshot.spectrogramCapacity, frames.getFrameSize(), frames.getFormat());
+        writePosition = 0;
+        wrapped = false;
+        nextFrame = first;
+        spectrogramDirty = spectrogramDirty || ! freezeEnabled;
+    }
+
+    // A snapshot the processor could not refresh still holds frames that were already appended.
+    if (end <= nextFrame || spectrogramData.getNumFrames() <= 0)
+        return;
+
+    SpectrogramFrames fresh;
+    const SpectrogramFrames* source = &frames;
+    if (first < nextFrame)
+    {
+        fresh = frames;
+        fresh.dropOldestFrames ((int) (nextFrame - first));
+        source = &fresh;
+    }
+
+    const int capacity = spectrogramData.getNumFrames();
+    spectrogramData.copyIntoRing (*source, (std::uint64_t) writePosition);
+
+    const int total = writePosition + source->getNumFrames();
+    wrapped = wrapped || total >= capacity;
+    writePosition = total % capacity;
+    nextFrame = end;
+}
+
 void SpectrogramMeter::paint (juce::Graphics& g)
 {
     auto panelBounds = drawPanelFrame (g);
@@ -233,7 +294,25 @@ void SpectrogramMeter::paint (juce::Graphics& g)
     if (spectrogramImage.isValid() && hasData)
     {
         g.setOpacity (1.0f);
-        g.drawImage (spectrogramImage, heatmapArea, juce::RectanglePlacement::stretchToFit);
+
+        // The image is a ring, so the visible columns are blitted oldest first in up to two pieces.
+        const int imageColumns = spectrogramImage.getWidth();
+        const int oldest = (int) ((imageFrameEnd - (std::uint64_t) visibleColumns) % (std::uint64_t) imageColumns);
+        const int firstCount = juce::jmin (visibleColumns, imageColumns - oldest);
+        const float columnWidth = heatmapArea.getWidth() / (float) visibleColumns;
+        const auto destination = heatmapArea.toNearestInt();
+
+        auto drawColumns = [&] (int sourceX, int count, int firstColumn)
+        {
+            const int left = juce::roundToInt (heatmapArea.getX() + columnWidth * (float) firstColumn);
+            const int right = juce::roundToInt (heatmapArea.getX() + columnWidth * (float) (firstColumn + count));
+            g.drawImage (spectrogramImage, left, destination.getY(), right - left, destination.getHeight(),
+                         sourceX, 0, count, spectrogramImage.getHeight());
+        };
+
+        drawColumns (oldest, firstCount, 0);
+        if (firstCount < visibleColumns)
+            drawColumns (0, visibleColumns - firstCount, firstCount);
 
         auto highlight = heatmapArea.withX (heatmapArea.getRight() - heatmapArea.getWidth() / juce::jmax (1, visibleColumns));
         g.setColour (theme.secondary.withAlpha (0.08f));
@@ -263,7 +342,8 @@ void SpectrogramMeter::resized()
     auto bounds = getPanelContentBounds().toNearestInt();
 
     auto controlArea = bounds.removeFromTop (controlsHeight);
-    auto combosRow = controlArea.removeFromTop (controlArea.getHeight() / 2);
+    auto combosRow = controlArea.removeFromTop (controlArea.getHeight() / 3);
+    analysisControls.setBounds (controlArea.removeFromTop (controlArea.getHeight() / 2));
     auto togglesRow = controlArea;
 
     const int comboSpacing = 6;
@@ -328,141 +408,228 @@ void SpectrogramMeter::refreshImage()
     visibleColumns = 0;
     visibleSeconds = 0.0;
 
-    const int totalColumns = spectrogramData.getNumSamples();
-    const int bins = spectrogramData.getNumChannels();
+    // While frozen the image is redrawn from the columns captured when freezing, which end at imageFrameEnd.
+    const auto& source = freezeEnabled ? orderedColumns : spectrogramData;
+    const int bins = source.getFrameSize();
+
+    if (snapshotSecondsPerColumn > 0.0)
+        secondsPerColumn = snapshotSecondsPerColumn;
+    else
+        secondsPerColumn = (bins > 0 && sampleRate > 0.0) ? ((double) bins / 2.0) / sampleRate : 0.0;
+
+    int imageColumns = 0;
+    if (freezeEnabled)
+    {
+        visibleColumns = getVisibleColumnCount (orderedColumns.getNumFrames());
+        imageColumns = visibleColumns;
+    }
+    else
+    {
+        const int capacity = spectrogramData.getNumFrames();
+        visibleColumns = getVisibleColumnCount (wrapped ? capacity : juce::jlimit (0, capacity, writePosition));
+        imageColumns = getVisibleColumnCount (capacity);
+        orderedColumns.copyFromRing (spectrogramData, (std::uint64_t) (writePosition + capacity - visibleColumns), visibleColumns);
+        imageFrameEnd = nextFrame;
+    }
 
-    if (bins <= 0 || totalColumns <= 0)
+    if (bins <= 0 || visibleColumns <= 0)
     {
+        visibleColumns = 0;
         spectrogramImage = {};
-        orderedColumns.setSize (0, 0);
         return;
     }
 
-    const bool wrappedHistory = wrapped && totalColumns > 0;
-    const int availableColumns = wrappedHistory ? totalColumns
-                                                : juce::jlimit (0, totalColumns, writePosition);
+    visibleSeconds = secondsPerColumn * visibleColumns;
 
-    if (availableColumns <= 0)
+    const int outputHeight = juce::jlimit (1, maxImageRows, bins);
+    if (spectrogramImage.getWidth() != imageColumns || spectrogramImage.getHeight() != outputHeight)
+        spectrogramImage = juce::Image (juce::Image::ARGB, imageColumns, outputHeight, false);
+
+    rebuildFilterbank (bins, outputHeight);
+    rebuildCodeColours();
+
+    juce::Image::BitmapData pixels (spectrogramImage, juce::Image::BitmapData::writeOnly);
+    const int columnOffset = orderedColumns.getNumFrames() - visibleColumns;
+    const auto firstFrame = imageFrameEnd - (std::uint64_t) visibleColumns;
+    for (int i = 0; i < visibleColumns; ++i)
+        drawColumn (pixels, (int) ((firstFrame + (std::uint64_t) i) % (std::uint64_t) imageColumns), orderedColumns, columnOffset + i);
+
+    hasData = true;
+}
+
+void SpectrogramMeter::drawNewColumns()
+{
+    const int imageColumns = spectrogramImage.getWidth();
+    const int capacity = spectrogramData.getNumFrames();
+
+    // Anything that no longer fits the image as a ring of new columns takes a full redraw.
+    if (! hasData || nextFrame < imageFrameEnd || nextFrame - imageFrameEnd >= (std::uint64_t) imageColumns
+        || spectrogramData.getFrameSize() != orderedColumns.getFrameSize())
     {
-        spectrogramImage = {};
-        orderedColumns.setSize (0, 0);
+        refreshImage();
         return;
     }
 
-    orderedColumns.setSize (bins, availableColumns, false, false, true);
+    juce::Image::BitmapData pixels (spectrogramImage, juce::Image::BitmapData::writeOnly);
+    for (auto frame = imageFrameEnd; frame < nextFrame; ++frame)
+    {
+        const int age = (int) (nextFrame - frame);
+        drawColumn (pixels, (int) (frame % (std::uint64_t) imageColumns), spectrogramData, (writePosition + capacity - age) % capacity);
+    }
 
-    const int startIndex = wrappedHistory ? writePosition : juce::jmax (0, juce::jmin (writePosition, totalColumns));
+    imageFrameEnd = nextFrame;
+    visibleColumns = juce::jmin (imageColumns, getVisibleColumnCount (wrapped ? capacity : writePosition));
+    visibleSeconds = secondsPerColumn * visibleColumns;
+}
 
-    for (int bin = 0; bin < bins; ++bin)
+void SpectrogramMeter::drawColumn (juce::Image::BitmapData& pixels, int x, const SpectrogramFrames& frames, int index) const
+{
+    // Each row sums the powers of the bins under its filter, looked up per code, and takes one log for
+    // the band energy, so a narrow tone in a wide row reads at its own level rather than the noise floor.
+    auto drawCodes = [&] (const auto* frame)
     {
-        const float* src = spectrogramData.getReadPointer (bin);
-        float* dest = orderedColumns.getWritePointer (bin);
-
-        if (wrappedHistory)
-        {
-            int destIndex = 0;
-            for (int column = 0; column < availableColumns; ++column)
-            {
-                const int srcIndex = (startIndex + column) % totalColumns;
-                dest[destIndex++] = src[srcIndex];
-            }
-        }
-        else
+        for (int y = 0; y < pixels.height; ++y)
         {
-            std::copy (src, src + availableColumns, dest);
+            const auto* codes = frame + filterbankFirstBins[(size_t) y];
+            const float* weights = filterbankWeights.data() + filterbankOffsets[(size_t) y];
+            const int count = filterbankOffsets[(size_t) y + 1] - filterbankOffsets[(size_t) y];
+
+            float power = 0.0f;
+            for (int i = 0; i < count; ++i)
+                power += weights[i] * codePowers[(size_t) codes[i]];
+
+            const float decibels = 10.0f * std::log10 (juce::jmax (power, 1.0e-30f));
+            const float code = juce::jlimit (0.0f, (float) maxCode, (decibels - codeFloorDb) * codesPerDb);
+
+            auto* pixel = reinterpret_cast<juce::PixelARGB*> (pixels.getPixelPointer (x, y));
+            *pixel = codeColours[(size_t) (code + 0.5f)];
         }
-    }
+    };
 
-    const double nyquist = sampleRate * 0.5;
-    secondsPerColumn = (bins > 0 && sampleRate > 0.0) ? ((double) bins / 2.0) / sampleRate : 0.0;
-    visibleColumns = getVisibleColumnCount (availableColumns);
-    visibleSeconds = secondsPerColumn * visibleColumns;
+    if (frames.getFormat() == SpectrogramFrames::Format::decibels8)
+        drawCodes (frames.getFrame8 (index));
+    else
+        drawCodes (frames.getFrame16 (index));
+}
 
-    if (visibleColumns <= 0)
+double SpectrogramMeter::frequencyToScale (FrequencyScale scale, double frequency) noexcept
+{
+    switch (scale)
     {
-        spectrogramImage = {};
-        orderedColumns.setSize (0, 0);
-        return;
+        case FrequencyScale::logarithmic: return std::log10 (juce::jmax (1.0, frequency));
+        case FrequencyScale::mel:         return 2595.0 * std::log10 (1.0 + frequency / 700.0);
+        case FrequencyScale::bark:        return 26.81 * frequency / (1960.0 + frequency) - 0.53;
+        case FrequencyScale::erb:         return 21.4 * std::log10 (1.0 + 0.00437 * frequency);
+        case FrequencyScale::linear:      break;
     }
 
-    const int outputHeight = juce::jmax (1, bins);
-    spectrogramImage = juce::Image (juce::Image::ARGB, visibleColumns, outputHeight, false);
+    return frequency;
+}
 
-    const int columnOffset = juce::jmax (0, availableColumns - visibleColumns);
+double SpectrogramMeter::getScaleMinimumFrequency (FrequencyScale scale) noexcept
+{
+    return scale == FrequencyScale::logarithmic ? 20.0 : 0.0;
+}
 
-    if ((int) binRemap.size() != outputHeight)
-        binRemap.resize ((size_t) outputHeight);
+void SpectrogramMeter::rebuildFilterbank (int bins, int rows)
+{
+    const auto scale = (FrequencyScale) scaleBox.getSelectedId();
+    const bool hasBinFrequencies = binFrequencies.size() == (size_t) bins && bins > 1;
+
+    if (filterbankScale == scale && filterbankBins == bins && filterbankSampleRate == sampleRate
+        && (int) filterbankFirstBins.size() == rows && filterbankBinFrequencies == (hasBinFrequencies ? binFrequencies : std::vector<float>()))
+        return;
 
-    const auto scaleMode = (FrequencyScale) scaleBox.getSelectedId();
-    const double minFreq = 20.0;
-    const double maxFreq = juce::jmax (minFreq * 1.01, nyquist);
-    const double logMin = std::log10 (minFreq);
-    const double logMax = std::log10 (maxFreq);
-    const double logRange = juce::jmax (1.0e-6, logMax - logMin);
-    const double freqRange = juce::jmax (1.0, maxFreq - minFreq);
-    const double denom = (double) juce::jmax (1, bins - 1);
+    filterbankScale = scale;
+    filterbankBins = bins;
+    filterbankSampleRate = sampleRate;
+    filterbankBinFrequencies = hasBinFrequencies ? binFrequencies : std::vector<float>();
 
-    for (int y = 0; y < outputHeight; ++y)
+    // Multi-resolution frames carry their own (log-spaced) bin frequencies; FFT bins are uniform.
+    const double nyquist = sampleRate * 0.5;
+    std::vector<double> binPositions ((size_t) bins);
+    for (int k = 0; k < bins; ++k)
     {
-        const float ratio = outputHeight > 1 ? (float) y / (float) (outputHeight - 1) : 0.0f;
-        const float inverted = 1.0f - ratio;
+        const double frequency = hasBinFrequencies ? (double) binFrequencies[(size_t) k] : nyquist * (double) k / (double) bins;
+        binPositions[(size_t) k] = frequencyToScale (scale, frequency);
+    }
+
+    const double minPosition = frequencyToScale (scale, getScaleMinimumFrequency (scale));
+    const double maxPosition = frequencyToScale (scale, juce::jmax (getScaleMinimumFrequency (scale) + 1.0, nyquist));
+    const double step = (maxPosition - minPosition) / (double) juce::jmax (1, rows - 1);
 
-        double targetBin = 0.0;
-        if (scaleMode == FrequencyScale::logarithmic)
+    filterbankFirstBins.resize ((size_t) rows);
+    filterbankOffsets.assign (1, 0);
+    filterbankOffsets.reserve ((size_t) rows + 1);
+    filterbankWeights.clear();
+
+    for (int y = 0; y < rows; ++y)
+    {
+        // Triangles reach the neighbouring rows' centres, so adjacent rows overlap by half and each bin's
+        // weights across rows sum to one: every row integrates its band and the rows together conserve power.
+        const double centre = maxPosition - step * (double) y;
+        const auto first = (int) std::distance (binPositions.begin(), std::upper_bound (binPositions.begin(), binPositions.end(), centre - step));
+        const auto last = (int) std::distance (binPositions.begin(), std::lower_bound (binPositions.begin(), binPositions.end(), centre + step)) - 1;
+
+        const size_t rowStart = filterbankWeights.size();
+        for (int k = first; k <= last; ++k)
+            filterbankWeights.push_back ((float) (1.0 - std::abs (binPositions[(size_t) k] - centre) / step));
+
+        if (last - first + 1 >= 2)
         {
-            const double logPos = logMin + logRange * inverted;
-            const double frequency = std::pow (10.0, logPos);
-            const double normalised = juce::jlimit (0.0, 1.0, (frequency - minFreq) / freqRange);
-            targetBin = normalised * denom;
+            filterbankFirstBins[(size_t) y] = first;
         }
         else
         {
-            targetBin = inverted * denom;
+            // Rows narrower than a bin interpolate between the two bins around their centre.
+            filterbankWeights.resize (rowStart);
+            const auto above = std::lower_bound (binPositions.begin(), binPositions.end(), centre);
+            const int upper = juce::jlimit (0, bins - 1, (int) std::distance (binPositions.begin(), above));
+            const int lower = juce::jmax (0, upper - 1);
+            const double span = binPositions[(size_t) upper] - binPositions[(size_t) lower];
+            const float fraction = span > 0.0 ? (float) juce::jlimit (0.0, 1.0, (centre - binPositions[(size_t) lower]) / span) : 0.0f;
+
+            filterbankFirstBins[(size_t) y] = lower;
+            filterbankWeights.push_back (1.0f - fraction);
+            if (upper > lower)
+                filterbankWeights.push_back (fraction);
         }
 
-        binRemap[(size_t) y] = (float) juce::jlimit (0.0, denom, targetBin);
+        filterbankOffsets.push_back ((int) filterbankWeights.size());
     }
+}
 
-    const auto* readPointers = orderedColumns.getArrayOfReadPointers();
-    juce::Image::BitmapData pixels (spectrogramImage, juce::Image::BitmapData::writeOnly);
-
-    constexpr float epsilon = 1.0e-6f;
-    const float range = juce::jmax (0.01f, maxDb - minDb);
+void SpectrogramMeter::rebuildCodeColours()
+{
+    const int numCodes = orderedColumns.getMaxCode() + 1;
+    const float gamma = (float) intensitySlider.getValue();
 
-    for (int x = 0; x < visibleColumns; ++x)
+    if ((int) codePowers.size() != numCodes)
     {
-        for (int y = 0; y < outputHeight; ++y)
-        {
-            const int sourceColumn = columnOffset + x;
-            const float remap = binRemap[(size_t) y];
-            const int lower = (int) std::floor (remap);
-            const int upper = juce::jmin (bins - 1, lower + 1);
-            const float fraction = remap - (float) lower;
-
-            float value = 0.0f;
-            if (bins <= 1)
-            {
-                value = readPointers[0][sourceColumn];
-            }
-            else
-            {
-                const float lowerValue = readPointers[lower][sourceColumn];
-                const float upperValue = readPointers[upper][sourceColumn];
-                value = lowerValue + fraction * (upperValue - lowerValue);
-            }
-
-            float db = juce::Decibels::gainToDecibels (juce::jmax (value, epsilon));
-            db = juce::jlimit (minDb, maxDb, db);
-            float normalised = (db - minDb) / range;
-            normalised = juce::jlimit (0.0f, 1.0f, normalised);
-
-            juce::Colour colour = colourForMagnitude (normalised);
-            auto* pixel = reinterpret_cast<juce::PixelARGB*> (pixels.getPixelPointer (x, y));
-            pixel->setARGB (255, colour.getRed(), colour.getGreen(), colour.getBlue());
-        }
+        codePowers.resize ((size_t) numCodes);
+        for (int code = 0; code < numCodes; ++code)
+            codePowers[(size_t) code] = std::pow (10.0f, orderedColumns.codeToDecibels (code) / 10.0f);
+
+        maxCode = numCodes - 1;
+        codeFloorDb = orderedColumns.codeToDecibels (0);
+        codesPerDb = 1.0f / (orderedColumns.codeToDecibels (1) - codeFloorDb);
     }
 
-    hasData = true;
+    if ((int) codeColours.size() == numCodes && codeColoursMinDb == minDb && codeColoursMaxDb == maxDb && codeColoursGamma == gamma)
+        return;
+
+    codeColours.resize ((size_t) numCodes);
+    codeColoursMinDb = minDb;
+    codeColoursMaxDb = maxDb;
+    codeColoursGamma = gamma;
+
+    const float range = juce::jmax (0.01f, maxDb - minDb);
+    for (int code = 0; code < numCodes; ++code)
+    {
+        const float db = juce::jlimit (minDb, maxDb, orderedColumns.codeToDecibels (code));
+        const auto colour = colourForMagnitude ((db - minDb) / range);
+        codeColours[(size_t) code].setARGB (255, colour.getRed(), colour.getGreen(), colour.getBlue());
+    }
 }
 
 void SpectrogramMeter::refreshStatusText()
@@ -480,7 +647,7 @@ void SpectrogramMeter::refreshStatusText()
         text << "  |  " << visibleColumns << " frames";
         text << "  |  Floor " << juce::String (minDb, 0) << " dB";
         text << "  |  Glow " << juce::String (intensitySlider.getValue(), 1) << "x";
-        text << "  |  " << (scaleBox.getSelectedId() == (int) FrequencyScale::logarithmic ? "Log" : "Linear") << " freq";
+        text << "  |  " << scaleBox.getText() << " freq";
         text << "  |  Grid " << (gridEnabled ? "On" : "Off");
         const bool beatActive = beatGridEnabled && shouldDrawBeatGrid();
         text << "  |  Beat " << (beatActive ? "On" : "Off");
@@ -505,6 +672,7 @@ void SpectrogramMeter::updateControlColours()
     setCombo (scaleBox);
     setCombo (paletteBox);
     setCombo (timeSpanBox);
+    analysisControls.applyTheme (theme);
 
     auto setToggle = [this] (juce::ToggleButton& button)
     {
@@ -542,6 +710,7 @@ void SpectrogramMeter::updateControlColours()
 void SpectrogramMeter::rebuildColourLut()
 {
     colourLutDirty = false;
+    codeColours.clear();
 
     auto gradient = createPaletteGradient();
     const int size = (int) colourLut.size();
@@ -712,24 +881,12 @@ void SpectrogramMeter::drawTimeAxis (juce::Graphics& g,
 
 float SpectrogramMeter::frequencyToY (double frequency, juce::Rectangle<float> plotBounds) const
 {
-    const double nyquist = juce::jmax (20.0, sampleRate * 0.5);
-    double ratio = 0.0;
-
-    if ((FrequencyScale) scaleBox.getSelectedId() == FrequencyScale::logarithmic)
-    {
-        const double minFreq = 20.0;
-        const double maxFreq = juce::jmax (minFreq * 1.01, nyquist);
-        const double clamped = juce::jlimit (minFreq, maxFreq, frequency);
-        const double logMin = std::log10 (minFreq);
-        const double logMax = std::log10 (maxFreq);
-        const double logRange = juce::jmax (1.0e-6, logMax - logMin);
-        ratio = (std::log10 (clamped) - logMin) / logRange;
-    }
-    else
-    {
-        const double clamped = juce::jlimit (0.0, nyquist, frequency);
-        ratio = clamped / juce::jmax (1.0, nyquist);
-    }
+    const auto scale = (FrequencyScale) scaleBox.getSelectedId();
+    const double minFreq = getScaleMinimumFrequency (scale);
+    const double maxFreq = juce::jmax (minFreq + 1.0, sampleRate * 0.5);
+    const double minPosition = frequencyToScale (scale, minFreq);
+    const double range = juce::jmax (1.0e-6, frequencyToScale (scale, maxFreq) - minPosition);
+    const double ratio = (frequencyToScale (scale, juce::jlimit (minFreq, maxFreq, frequency)) - minPosition) / range;
 
     const float position = (float) juce::jlimit (0.0, 1.0, ratio);
     return plotBounds.getBottom() - position * plotBounds.getHeight();
@@ -11,20 +11,35 @@ public:
     SpectrogramMeter();
 
     void update (const SharedDataSnapshot& snapshot, const MeterTheme& newTheme) override;
+    std::uint32_t getSnapshotSections() const noexcept override { return SharedDataSnapshot::spectrogramData; }
     void paint (juce::Graphics& g) override;
     void resized() override;
 
+    void setAnalysisSettings (const SpectrumAnalysisSettings& newSettings) { analysisControls.setSettings (newSettings); }
+    void setOnAnalysisSettingsChanged (std::function<void (const SpectrumAnalysisSettings&)> callback) { analysisControls.onSettingsChanged = std::move (callback); }
+
 private:
     enum class FrequencyScale
     {
         linear = 1,
-        logarithmic
+        logarithmic,
+        mel,
+        bark,
+        erb
     };
 
+    static double frequencyToScale (FrequencyScale scale, double frequency) noexcept;
+    static double getScaleMinimumFrequency (FrequencyScale scale) noexcept;
+
+    void appendSpectrogramFrames (const SharedDataSnapshot& snapshot);
     void refreshImage();
+    void drawNewColumns();
+    void drawColumn (juce::Image::BitmapData& pixels, int x, const SpectrogramFrames& frames, int index) const;
+    void rebuildFilterbank (int bins, int rows);
     void refreshStatusText();
     void updateControlColours();
     void rebuildColourLut();
+    void rebuildCodeColours();
     juce::ColourGradient createPaletteGradient() const;
     juce::Colour colourForMagnitude (float magnitude);
 
@@ -53,16 +68,39 @@ private:
     float frequencyToY (double frequency, juce::Rectangle<float> plotBounds) const;
     std::vector<double> getGridFrequencies() const;
 
-    juce::AudioBuffer<float> spectrogramData;
-    juce::AudioBuffer<float> orderedColumns;
+    SpectrogramFrames spectrogramData;
+    SpectrogramFrames orderedColumns;
+
+    // A ring of columns: frame f is drawn at x = f % width, and the newest one ends at imageFrameEnd.
     juce::Image spectrogramImage;
-    std::vector<float> binRemap;
+    std::uint64_t imageFrameEnd = 0;
+    std::vector<float> binFrequencies;
+
+    // Sparse triangular filterbank, one run of contiguous bins per image row (row 0 is the top).
+    std::vector<int> filterbankFirstBins;
+    std::vector<int> filterbankOffsets;
+    std::vector<float> filterbankWeights;
+    std::vector<float> filterbankBinFrequencies;
+    FrequencyScale filterbankScale = FrequencyScale::linear;
+    int filterbankBins = 0;
+    double filterbankSampleRate = 0.0;
     std::array<juce::Colour, 512> colourLut {};
     bool colourLutDirty = true;
+    std::vector<juce::PixelARGB> codeColours;
+    float codeColoursMinDb = 0.0f;
+    float codeColoursMaxDb = 0.0f;
+    float codeColoursGamma = 0.0f;
+
+    // Linear power of every dB code, and the inverse mapping used once per row.
+    std::vector<float> codePowers;
+    float codeFloorDb = 0.0f;
+    float codesPerDb = 1.0f;
+    int maxCode = 0;
 
     juce::ComboBox scaleBox;
     juce::ComboBox paletteBox;
     juce::ComboBox timeSpanBox;
+    SpectrumAnalysisControls analysisControls;
     juce::ToggleButton freezeButton { "Freeze" };
     juce::ToggleButton gridButton { "Grid" };
     juce::ToggleButton beatGridButton { "Beat Grid" };
@@ -80,6 +118,7 @@ private:
     bool beatGridEnabled = true;
     int visibleColumns = 0;
     double secondsPerColumn = 0.0;
+    double snapshotSecondsPerColumn = 0.0;
     double visibleSeconds = 0.0;
     float minDb = -120.0f;
     float maxDb = -5.0f;
@@ -87,9 +126,11 @@ private:
     bool spectrogramDirty = true;
     int writePosition = 0;
     bool wrapped = false;
+    std::uint64_t nextFrame = 0;
     double targetSpanSeconds = 3.0;
 
-    static constexpr int controlsHeight = 68;
+    static constexpr int maxImageRows = 1024;
+    static constexpr int controlsHeight = 102;
     static constexpr int slidersHeight = 40;
     static constexpr int axisHeight = 24;
     static constexpr int statusHeight = 24;